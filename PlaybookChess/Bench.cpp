@@ -0,0 +1,70 @@
+// Bench.cpp
+// Handles the search benchmark
+
+#include "Bench.hpp"
+#include "Search.hpp"
+#include "Notation.hpp"
+#include <ostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+double processCpuSeconds() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+	auto toSeconds = [](const FILETIME& t) { return ((static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime) / 1e7; };
+	return toSeconds(kernel) + toSeconds(user);
+#else
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
+
+const std::vector<std::string>& benchPositions() {
+	static const std::vector<std::string> positions = {
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+		"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+		"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+		"r2q1rk1/pp2bppp/2n1pn2/3p4/3P4/2NBPN2/PP3PPP/R2Q1RK1 w - - 0 10",
+		"2r3k1/pp3pp1/4p2p/3n4/3P4/P4N1P/1P3PP1/2R3K1 w - - 0 25",
+		"8/5pk1/6p1/7p/7P/6P1/5PK1/3R4 w - - 0 40",
+		"8/8/4k3/8/2K5/3P4/8/8 w - - 0 60",
+		"6k1/5pp1/7p/8/8/8/5PPP/3R2K1 w - - 0 30",
+	};
+	return positions;
+}
+
+BenchResult runBench(int depth, int threads, int hashMb, std::ostream* out) {
+	BenchResult total;
+	TranspositionTable tt(hashMb);
+	Search search(tt, threads);
+
+	SearchLimits limits;
+	limits.depth = depth;
+
+	for (const std::string& fen : benchPositions()) {
+		Position position;
+		position.setFromFen(fen);
+		tt.clear();
+
+		SearchResult r = search.think(position, limits);
+		total.nodes += r.nodes;
+		total.seconds += r.seconds;
+		if (out) {
+			*out << fen << "\n  depth " << r.depth << " score " << r.score << " nodes " << r.nodes
+				<< " best " << (r.hasMove ? moveToString(r.bestMove) : "(none)") << "\n";
+		}
+	}
+	return total;
+}
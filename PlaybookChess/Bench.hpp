@@ -0,0 +1,21 @@
+// Bench.hpp
+// Fixed-depth search benchmark over a set of positions
+
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+	std::uint64_t nodes = 0;
+	double seconds = 0;
+	std::uint64_t nps() const { return seconds > 0 ? static_cast<std::uint64_t>(nodes / seconds) : 0; }
+};
+
+const std::vector<std::string>& benchPositions(); // FENs searched by the benchmark
+
+double processCpuSeconds(); // CPU time used by the whole process so far, in seconds, counting every thread
+
+// Searches every bench position to depth with a fresh hash table, printing one line per position to out if given
+BenchResult runBench(int depth, int threads = 1, int hashMb = 16, std::ostream* out = nullptr);
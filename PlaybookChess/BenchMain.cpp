@@ -0,0 +1,38 @@
+// BenchMain.cpp
+// Headless search benchmark
+// Usage: bench [--depth n] [--target nps] [--threads n]
+// Exits with an error if the single-thread speed is below the target, default 750,000 nodes per second.
+// With --threads above 1 the suite is searched again in parallel and the speedup over one thread is reported.
+
+#include "Bench.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+	int depth = 6;
+	int threads = 1;
+	std::uint64_t target = 750000;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--depth") depth = std::atoi(argv[i + 1]);
+		else if (arg == "--threads") threads = std::atoi(argv[i + 1]);
+		else if (arg == "--target") target = std::strtoull(argv[i + 1], nullptr, 10);
+	}
+
+	BenchResult single = runBench(depth, 1, 16, &std::cout);
+
+	std::cout << "\nNodes: " << single.nodes << "\n";
+	std::cout << "Time: " << single.seconds << " s\n";
+	std::cout << "NPS: " << single.nps() << " (target " << target << ")" << std::endl;
+
+	if (threads > 1) {
+		BenchResult parallel = runBench(depth, threads, 16, nullptr);
+		std::cout << "\n" << threads << " threads\n";
+		std::cout << "Nodes: " << parallel.nodes << "\n";
+		std::cout << "Time to depth " << depth << ": " << parallel.seconds << " s (speedup " << single.seconds / parallel.seconds << "x)\n";
+		std::cout << "NPS: " << parallel.nps() << " (" << static_cast<double>(parallel.nps()) / single.nps() << "x)" << std::endl;
+	}
+	return single.nps() >= target ? 0 : 1;
+}
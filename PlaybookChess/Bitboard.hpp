@@ -0,0 +1,140 @@
+// Bitboard.hpp
+// 64-bit square sets and bit helpers
+// Compile-time leaper attack tables, magic bitboard slider attacks, and between-square masks
+
+#pragma once
+#include "Types.hpp"
+#include <array>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+using Bitboard = std::uint64_t; // One bit per square, bit 0 is a1 and bit 63 is h8
+
+constexpr Bitboard squareBB(int sq) { return Bitboard(1) << sq; }
+constexpr Bitboard FileABB = 0x0101010101010101ULL;
+constexpr Bitboard FileHBB = FileABB << 7;
+constexpr Bitboard rankBB(int rank) { return Bitboard(0xFF) << (8 * (rank - 1)); }
+
+// Moves every square by Delta, squares pushed past rank 1 or 8 fall off. Callers mask out wrapping files first.
+template<int Delta>
+constexpr Bitboard shiftBB(Bitboard b) {
+	if constexpr (Delta > 0) return b << Delta;
+	else return b >> -Delta;
+}
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER)
+	return static_cast<int>(__popcnt64(b));
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the lowest set bit, b must not be empty
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward64(&idx, b);
+	return static_cast<int>(idx);
+#else
+	return __builtin_ctzll(b);
+#endif
+}
+
+// Removes and returns the lowest set bit
+inline int popLsb(Bitboard& b) {
+	int sq = lsb(b);
+	b &= b - 1;
+	return sq;
+}
+
+// Square offset by (df, dr) as a bitboard, empty if it falls off the board
+constexpr Bitboard offsetBB(int sq, int df, int dr) {
+	int f = sq % 8 + df;
+	int r = sq / 8 + dr;
+	return (f < 0 || f > 7 || r < 0 || r > 7) ? 0 : squareBB(r * 8 + f);
+}
+
+constexpr std::array<Bitboard, 64> makeKnightAttacks() {
+	std::array<Bitboard, 64> table{};
+	for (int sq = 0; sq < 64; sq++)
+		table[sq] = offsetBB(sq, 1, 2) | offsetBB(sq, 2, 1) | offsetBB(sq, 2, -1) | offsetBB(sq, 1, -2)
+			| offsetBB(sq, -1, -2) | offsetBB(sq, -2, -1) | offsetBB(sq, -2, 1) | offsetBB(sq, -1, 2);
+	return table;
+}
+
+constexpr std::array<Bitboard, 64> makeKingAttacks() {
+	std::array<Bitboard, 64> table{};
+	for (int sq = 0; sq < 64; sq++)
+		table[sq] = offsetBB(sq, 1, 0) | offsetBB(sq, 1, 1) | offsetBB(sq, 0, 1) | offsetBB(sq, -1, 1)
+			| offsetBB(sq, -1, 0) | offsetBB(sq, -1, -1) | offsetBB(sq, 0, -1) | offsetBB(sq, 1, -1);
+	return table;
+}
+
+constexpr std::array<std::array<Bitboard, 64>, 2> makePawnAttacks() {
+	std::array<std::array<Bitboard, 64>, 2> table{};
+	for (int sq = 0; sq < 64; sq++) {
+		table[White][sq] = offsetBB(sq, -1, 1) | offsetBB(sq, 1, 1);
+		table[Black][sq] = offsetBB(sq, -1, -1) | offsetBB(sq, 1, -1);
+	}
+	return table;
+}
+
+// Leaper attacks are built by the compiler, no startup work or abs() deltas
+inline constexpr std::array<Bitboard, 64> KnightAttacks = makeKnightAttacks();
+inline constexpr std::array<Bitboard, 64> KingAttacks = makeKingAttacks();
+inline constexpr std::array<std::array<Bitboard, 64>, 2> PawnAttacks = makePawnAttacks(); // Diagonal capture squares for a pawn of each color
+
+extern Bitboard BetweenBB[64][64]; // Squares strictly between two squares on a shared line, empty if not aligned
+extern Bitboard LineBB[64][64]; // Whole rank, file, or diagonal through two squares, empty if not aligned
+
+// Slider lookup for one square. The relevant occupancy (mask) is hashed into a per-square table,
+// by multiply and shift with a magic number, or by PEXT when built with USE_PEXT.
+struct Magic {
+	Bitboard mask = 0; // Squares whose occupancy affects the attacks, board edges excluded
+	Bitboard magic = 0;
+	const Bitboard* attacks = nullptr;
+	unsigned shift = 0;
+
+	unsigned index(Bitboard occupied) const {
+#if defined(USE_PEXT)
+		return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+		return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+	}
+};
+
+extern Magic RookMagics[64];
+extern Magic BishopMagics[64];
+
+inline Bitboard betweenBB(int from, int to) { return BetweenBB[from][to]; }
+inline Bitboard lineBB(int a, int b) { return LineBB[a][b]; }
+inline Bitboard knightAttacks(int sq) { return KnightAttacks[sq]; }
+inline Bitboard kingAttacks(int sq) { return KingAttacks[sq]; }
+inline Bitboard pawnAttacks(Color c, int sq) { return PawnAttacks[c][sq]; }
+
+// Sliding piece attacks, rays stop at (and include) the first occupied square
+inline Bitboard rookAttacks(int sq, Bitboard occupied) { return RookMagics[sq].attacks[RookMagics[sq].index(occupied)]; }
+inline Bitboard bishopAttacks(int sq, Bitboard occupied) { return BishopMagics[sq].attacks[BishopMagics[sq].index(occupied)]; }
+inline Bitboard queenAttacks(int sq, Bitboard occupied) { return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied); }
+
+// Compile-time versions for code templated on color or piece type, each call is one table lookup with no switch
+template<Color C>
+inline Bitboard pawnAttacks(int sq) { return PawnAttacks[C][sq]; }
+
+template<PieceType Pt>
+inline Bitboard attacks(int sq, Bitboard occupied) {
+	static_assert(Pt != PieceType::Pawn, "Pawn attacks depend on color, use pawnAttacks<C>");
+	if constexpr (Pt == PieceType::Knight) return knightAttacks(sq);
+	else if constexpr (Pt == PieceType::Bishop) return bishopAttacks(sq, occupied);
+	else if constexpr (Pt == PieceType::Rook) return rookAttacks(sq, occupied);
+	else if constexpr (Pt == PieceType::Queen) return queenAttacks(sq, occupied);
+	else return kingAttacks(sq);
+}
@@ -4,70 +4,111 @@
 
 #include "Board.hpp"
 #include "Rendering.hpp"
+#include <cmath>
+
+// Filled circle as a fan of triangles, it goes in the same vertex array as the highlight quads
+static void appendDisc(sf::VertexArray& vertices, sf::Vector2f center, float radius, sf::Color color) {
+	constexpr int segments = 16;
+	for (int i = 0; i < segments; i++) {
+		float a0 = 6.2831853f * i / segments, a1 = 6.2831853f * (i + 1) / segments;
+		vertices.append(sf::Vertex{ center, color });
+		vertices.append(sf::Vertex{ center + sf::Vector2f(std::cos(a0), std::sin(a0)) * radius, color });
+		vertices.append(sf::Vertex{ center + sf::Vector2f(std::cos(a1), std::sin(a1)) * radius, color });
+	}
+}
 
 // Build chess board squares
 void Board::initialize() {
-	for (int rank = 0; rank < 8; rank++) {
-		for (int file = 0; file < 8; file++) {
-			Square& sq = squares[rank][file]; // Reference to the current square
-			sq.rank = rank + 1;
-			sq.file = file + 1;
-			sq.shape.setSize({ squareSize, squareSize });
-			sq.shape.setPosition({ file * squareSize + 64.f, rank * squareSize + 64.f });
+	squareVertices.clear();
+	for (int rank = 1; rank < 9; rank++) {
+		for (int file = 1; file < 9; file++) {
 			bool isLight = (rank + file) % 2 == 0; // Checkerboard pattern
-			sq.shape.setFillColor(isLight ? sf::Color(238, 238, 210) : sf::Color(118, 150, 86)); // In line if statement with isLight bool to set square colors
+			appendQuad(squareVertices, squareRect(file, rank), isLight ? sf::Color(238, 238, 210) : sf::Color(118, 150, 86)); // In line if statement with isLight bool to set square colors
+		}
+	}
+	rebuildHighlights();
+}
+
+void Board::rebuildHighlights() {
+	highlightVertices.clear();
+
+	auto addHighlight = [&](const std::optional<std::pair<int, int>>& sq, sf::Color color) {
+		if (sq && sq->first > 0 && sq->first < 9 && sq->second > 0 && sq->second < 9)
+			appendQuad(highlightVertices, squareRect(sq->first, sq->second), color); // Blended on top of the squares
+	};
+
+	addHighlight(selectedSquare, sf::Color(255, 255, 0, 80)); // Yellow highlight
+	addHighlight(moveSquare, sf::Color(255, 255, 0, 180)); // More transparent yellow
+	addHighlight(checkHighlight, sf::Color(255, 165, 0, 120)); // Orange highlight
+	addHighlight(checkmateHighlight, sf::Color(255, 0, 0, 80)); // Red highlight
+
+	// Dots on empty destinations, a triangle in each corner of a capture so the piece stays visible
+	sf::Color hint(0, 0, 0, 60);
+	for (Bitboard b = hintTargets; b; ) {
+		int sq = popLsb(b);
+		sf::FloatRect rect = squareRect(fileOf(sq), rankOf(sq));
+		sf::Vector2f corner = rect.position, size = rect.size;
+		if (!(hintCaptures & squareBB(sq))) {
+			appendDisc(highlightVertices, corner + size / 2.f, size.x * 0.16f, hint);
+			continue;
+		}
+		float mark = size.x * 0.25f;
+		sf::Vector2f corners[4] = { corner, corner + sf::Vector2f(size.x, 0), corner + size, corner + sf::Vector2f(0, size.y) };
+		sf::Vector2f inward[4] = { { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+		for (int i = 0; i < 4; i++) {
+			highlightVertices.append(sf::Vertex{ corners[i], hint });
+			highlightVertices.append(sf::Vertex{ corners[i] + sf::Vector2f(inward[i].x * mark, 0), hint });
+			highlightVertices.append(sf::Vertex{ corners[i] + sf::Vector2f(0, inward[i].y * mark), hint });
 		}
 	}
+	dirty = false;
 }
 
 // Clear highlight from all squares
 void Board::clearHighlights() {
-	for (auto& row : squares)
-		for (auto& sq : row)
-			sq.isHighlighted = false;
-
 	checkHighlight.reset();
 	checkmateHighlight.reset();
+	hintTargets = hintCaptures = 0;
+	dirty = true;
 }
 
 void Board::setSelectedSquare(int file, int rank) {
 	selectedSquare = std::make_pair(file, rank);
+	dirty = true;
 }
 
 void Board::setMoveSquare(int file, int rank) {
 	moveSquare = std::make_pair(file, rank);
+	dirty = true;
 }
 
 void Board::setCheckHighlight(int file, int rank) {
 	checkHighlight = std::make_pair(file, rank);
+	dirty = true;
 }
 
 void Board::setCheckmateHighlight(int file, int rank) {
 	checkmateHighlight = std::make_pair(file, rank);
+	dirty = true;
 }
 
-// Draw squares
-void Board::draw(sf::RenderWindow& window) {
-	for (auto& row : squares) // Reference to row in squares array
-		for (auto& sq : row) // Reference to each square in row
-			window.draw(sq.shape);
-
-	auto drawHighlight = [&](int file, int rank, sf::Color color) {
-		if (file > 0 && file < 9 && rank > 0 && rank < 9) {
-			sf::RectangleShape highlight;
-			highlight.setSize({ squareSize, squareSize });
-			highlight.setPosition({ squares[rank - 1][file - 1].shape.getPosition() });
-			highlight.setFillColor(color);
-			window.draw(highlight);
-		}
-	};
+void Board::setMoveHints(Bitboard targets, Bitboard captures) {
+	if (targets == hintTargets && captures == hintCaptures) return; // Hovering within a square changes nothing
+	hintTargets = targets;
+	hintCaptures = captures & targets;
+	dirty = true;
+}
+
+void Board::clearMoveHints() {
+	setMoveHints(0, 0);
+}
+
+void Board::drawSquares(sf::RenderTarget& target) const {
+	target.draw(squareVertices);
+}
 
-	if (selectedSquare)
-		drawHighlight(selectedSquare->first, selectedSquare->second, sf::Color(255, 255, 0, 80)); // Yellow highlight
-	if (moveSquare)
-		drawHighlight(moveSquare->first, moveSquare->second, sf::Color(255, 255, 0, 180)); // More transparent yellow
-	if (checkHighlight)
-		drawHighlight(checkHighlight->first, checkHighlight->second, sf::Color(255, 165, 0, 120)); // Orange highlight
-	if (checkmateHighlight)
-		drawHighlight(checkmateHighlight->first, checkmateHighlight->second, sf::Color(255, 0, 0, 80)); // Red highlight
+// Draw highlights in one call, the vertices are only rebuilt after a highlight changes
+void Board::draw(sf::RenderTarget& target) {
+	if (dirty) rebuildHighlights();
+	target.draw(highlightVertices);
 }
\ No newline at end of file
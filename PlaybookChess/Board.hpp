@@ -1,36 +1,33 @@
 // Board.hpp
-// Square struct
 // Board class
 
 #pragma once
 #include <SFML/Graphics.hpp>
-#include <array>
-
-struct Square {
-	sf::RectangleShape shape;
-	int rank = 0;
-	int file = 0;
-	bool isHighlighted = false; // Check is square is selected by user
-
-	void draw(sf::RenderWindow& window) const { // Draws square using reference to window
-		window.draw(shape);
-	}
-};
+#include "Bitboard.hpp"
+#include <optional>
 
 class Board {
 private:
-	std::array<std::array<Square, 8>, 8> squares; // 8x8 array of squares
+	sf::VertexArray squareVertices{ sf::PrimitiveType::Triangles }; // 64 square quads, built once
+	sf::VertexArray highlightVertices{ sf::PrimitiveType::Triangles }; // Highlight quads, drawn on top of the squares
+	bool dirty = true; // Highlights changed since highlightVertices was last built
 	std::optional< std::pair<int, int> > selectedSquare;
 	std::optional< std::pair<int, int> > moveSquare;
 	std::optional< std::pair<int, int> > checkHighlight;
 	std::optional< std::pair<int, int> > checkmateHighlight;
+	Bitboard hintTargets = 0; // Legal destinations shown as dots
+	Bitboard hintCaptures = 0; // Destinations holding an enemy piece, shown as corner marks instead
 
 public:
 	void initialize(); // Initialize board function
+	void rebuildHighlights(); // Rebuilds highlightVertices from the current highlights
 	void clearHighlights();
-	void draw(sf::RenderWindow& window); // Draw function, takes window reference
+	void drawSquares(sf::RenderTarget& target) const; // Draws the plain squares, only needed when the static layer is rendered
+	void draw(sf::RenderTarget& target); // Draws the highlights over squares already drawn to target
 	void setSelectedSquare(int file, int rank);
 	void setMoveSquare(int file, int rank);
 	void setCheckHighlight(int file, int rank);
 	void setCheckmateHighlight(int file, int rank);
+	void setMoveHints(Bitboard targets, Bitboard captures); // Marks the legal destinations of the selected or hovered piece
+	void clearMoveHints();
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+// Book.hpp
+// OpeningBook class
+// Polyglot-format opening book, searched in place through a read-only memory map
+
+#pragma once
+#include "MappedFile.hpp"
+#include "Move.hpp"
+#include "Position.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BookMove {
+	Move move;
+	std::uint16_t weight = 0;
+};
+
+// Polyglot hash of a position: piece, castling, en passant, and side to move keys from one 781 entry table
+std::uint64_t polyglotKey(const Position& position);
+
+// Polyglot move encoding, castling is written as the king taking its own rook
+std::uint16_t toPolyglotMove(const Move& move);
+
+// Book file: 16 byte big-endian entries of key, move, weight, and learn, sorted by key.
+// Nothing is read at open, every probe is a binary search over the mapped entries.
+class OpeningBook {
+private:
+	MappedFile file;
+	std::size_t count = 0;
+
+	std::uint64_t keyAt(std::size_t index) const;
+
+public:
+	bool open(const std::string& path); // Returns false if the file cannot be mapped or is not a whole number of entries
+	bool isOpen() const { return count > 0; }
+	std::size_t size() const { return count; }
+
+	std::vector<BookMove> probe(Position& position) const; // Legal book moves for the position, O(log n) lookup
+	std::optional<Move> pick(Position& position, std::mt19937_64& rng) const; // Random book move, chosen in proportion to weight
+};
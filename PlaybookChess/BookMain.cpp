@@ -0,0 +1,100 @@
+// BookMain.cpp
+// Headless opening book tool, no window or SFML needed
+// Usage: book build <games.pgn> <book.bin> [--plies n] [--min n]   writes a Polyglot-format book from the first plies of each game
+//        book probe <book.bin> [fen]                                lists the book moves for a position, default is the start position
+
+#include "Book.hpp"
+#include "MappedFile.hpp"
+#include "Notation.hpp"
+#include "Validate.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+
+static void writeBigEndian(std::ostream& out, std::uint64_t value, int length) {
+	for (int i = length - 1; i >= 0; i--) out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static int build(const std::string& pgnPath, const std::string& bookPath, int plies, int minCount) {
+	MappedFile pgn;
+	if (!pgn.open(pgnPath)) {
+		std::cerr << "ERROR: Could not open " << pgnPath << std::endl;
+		return 1;
+	}
+
+	// Counts per position and move, the map keeps them sorted by key as the format requires
+	std::map<std::pair<std::uint64_t, std::uint16_t>, std::uint32_t> counts;
+	MoveVisitor countMove = [&](const Position& before, const Move& move, int ply) {
+		if (ply < plies) counts[{ polyglotKey(before), toPolyglotMove(move) }]++;
+	};
+	ValidationReport report = validateText(pgn.view(), InputFormat::Pgn, 1, false, countMove); // One thread, the map is not shared safely
+
+	std::ofstream out(bookPath, std::ios::binary);
+	if (!out) {
+		std::cerr << "ERROR: Could not write " << bookPath << std::endl;
+		return 1;
+	}
+	std::size_t entries = 0;
+	for (const auto& [entry, count] : counts) {
+		if (static_cast<int>(count) < minCount) continue;
+		writeBigEndian(out, entry.first, 8);
+		writeBigEndian(out, entry.second, 2);
+		writeBigEndian(out, std::min<std::uint32_t>(count, 0xFFFF), 2); // Weight is how often the move was played
+		writeBigEndian(out, 0, 4);
+		entries++;
+	}
+
+	std::cout << "Games: " << report.games << " (" << report.issues.size() << " with problems, stopped at the first illegal move)\n";
+	std::cout << "Entries: " << entries << " written to " << bookPath << std::endl;
+	return out ? 0 : 1;
+}
+
+static int probe(const std::string& bookPath, const std::string& fen) {
+	OpeningBook book;
+	if (!book.open(bookPath)) {
+		std::cerr << "ERROR: Could not open " << bookPath << std::endl;
+		return 1;
+	}
+	Position position;
+	if (!position.setFromFen(fen)) {
+		std::cerr << "ERROR: Invalid FEN: " << fen << std::endl;
+		return 1;
+	}
+
+	std::vector<BookMove> moves = book.probe(position);
+	std::uint32_t total = 0;
+	for (const BookMove& m : moves) total += m.weight;
+	for (const BookMove& m : moves)
+		std::cout << moveToSan(position, m.move) << " " << m.weight << " (" << (total ? 100.0 * m.weight / total : 0.0) << "%)\n";
+	std::cout << moves.size() << " book moves in " << book.size() << " entries" << std::endl;
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	std::string command = argc > 1 ? argv[1] : "";
+	if (command == "build" && argc >= 4) {
+		int plies = 16, minCount = 1;
+		for (int i = 4; i + 1 < argc; i += 2) {
+			std::string arg = argv[i];
+			if (arg == "--plies") plies = std::atoi(argv[i + 1]);
+			else if (arg == "--min") minCount = std::atoi(argv[i + 1]);
+		}
+		return build(argv[2], argv[3], plies, minCount);
+	}
+	if (command == "probe" && argc >= 3) {
+		std::string fen = StartFen;
+		if (argc > 3) {
+			fen.clear();
+			for (int i = 3; i < argc; i++) fen += std::string(i > 3 ? " " : "") + argv[i];
+		}
+		return probe(argv[2], fen);
+	}
+
+	std::cerr << "Usage: book build <games.pgn> <book.bin> [--plies n] [--min n]\n"
+		<< "       book probe <book.bin> [fen]" << std::endl;
+	return 2;
+}
@@ -0,0 +1,54 @@
+// EmbedAssets.cpp
+// Build step that packs the piece sprites into a decoded RGBA atlas and writes it, with the font, as a C++ source
+// Usage: embedassets <sprite directory> <font file> <output.cpp>
+
+#include "Rendering.hpp"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// Writes bytes as a comma separated array body, 24 per line
+static void writeBytes(std::ostream& out, const std::uint8_t* data, std::size_t size) {
+	for (std::size_t i = 0; i < size; i++) {
+		out << static_cast<unsigned>(data[i]) << ',';
+		if (i % 24 == 23) out << '\n';
+	}
+	out << '\n';
+}
+
+int main(int argc, char* argv[]) {
+	if (argc != 4) {
+		std::cerr << "Usage: embedassets <sprite directory> <font file> <output.cpp>" << std::endl;
+		return 1;
+	}
+
+	sf::Image atlas;
+	if (!packPieceAtlas(argv[1], atlas)) return 1;
+
+	std::ifstream fontFile(argv[2], std::ios::binary);
+	if (!fontFile) {
+		std::cerr << "ERROR: Could not load " << argv[2] << std::endl;
+		return 1;
+	}
+	std::vector<std::uint8_t> font((std::istreambuf_iterator<char>(fontFile)), std::istreambuf_iterator<char>());
+
+	std::ofstream out(argv[3], std::ios::binary);
+	if (!out) {
+		std::cerr << "ERROR: Could not write " << argv[3] << std::endl;
+		return 1;
+	}
+
+	sf::Vector2u size = atlas.getSize();
+	out << "// Generated by embedassets, do not edit\n\n#include \"sprites.h\"\n\n";
+	out << "const unsigned embeddedAtlasWidth = " << size.x << ";\n";
+	out << "const unsigned embeddedAtlasHeight = " << size.y << ";\n";
+	out << "const std::uint8_t embeddedAtlasPixels[] = {\n";
+	writeBytes(out, atlas.getPixelsPtr(), static_cast<std::size_t>(size.x) * size.y * 4);
+	out << "};\n\n";
+	out << "const std::uint8_t embeddedFont[] = {\n";
+	writeBytes(out, font.data(), font.size());
+	out << "};\n";
+	out << "const std::size_t embeddedFontSize = " << font.size() << ";\n";
+	return out ? 0 : 1;
+}
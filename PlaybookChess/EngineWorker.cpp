@@ -0,0 +1,82 @@
+// EngineWorker.cpp
+// Background search thread
+// EngineWorker class functions
+
+#include "EngineWorker.hpp"
+
+EngineWorker::EngineWorker(int threads, std::size_t hashMb) : tt(hashMb), search(tt, threads) {
+	thread = std::thread([this] { run(); });
+}
+
+EngineWorker::~EngineWorker() {
+	quit.store(true);
+	search.stop();
+	{
+		std::lock_guard<std::mutex> lock(idleMutex);
+	}
+	idleWake.notify_one();
+	thread.join();
+}
+
+std::uint32_t EngineWorker::startSearch(const Position& root, const SearchLimits& limits, const std::vector<std::uint64_t>& history) {
+	std::uint32_t id = nextId.fetch_add(1);
+	EngineRequest request;
+	request.id = id;
+	request.root = root;
+	request.limits = limits;
+	request.history = history;
+	if (!requests.push(std::move(request))) return 0;
+
+	// Taking the lock once per request, not per node, keeps the worker from missing the wake up
+	{
+		std::lock_guard<std::mutex> lock(idleMutex);
+	}
+	idleWake.notify_one();
+	return id;
+}
+
+void EngineWorker::stop(std::uint32_t id) {
+	stopId.store(id);
+	search.stop(); // If the search has not started yet, shouldStop catches it after the first iteration
+}
+
+void EngineWorker::cancel(std::uint32_t id) {
+	cancelId.store(id);
+	search.stop();
+}
+
+std::optional<EngineReport> EngineWorker::poll() {
+	return reports.pop();
+}
+
+void EngineWorker::postReport(EngineReport report, bool mustDeliver) {
+	// Iteration updates are dropped if the caller falls behind, the final result waits for room
+	while (!reports.push(report)) {
+		if (!mustDeliver || quit.load()) return;
+		std::this_thread::yield();
+	}
+}
+
+void EngineWorker::run() {
+	while (!quit.load()) {
+		std::optional<EngineRequest> request = requests.pop();
+		if (!request) {
+			std::unique_lock<std::mutex> lock(idleMutex);
+			idleWake.wait(lock, [this] { return quit.load() || !requests.empty(); });
+			continue;
+		}
+
+		std::uint32_t id = request->id;
+		if (cancelId.load() == id || quit.load()) continue; // Cancelled while waiting in the queue, a stopped request still searches one iteration
+
+		// think resets its stop flag when it starts, so a stop that arrives before then is applied here instead
+		auto onIteration = [this, id](const SearchResult& iteration) {
+			if (shouldStop(id)) search.stop();
+			else postReport({ id, false, iteration }, false);
+		};
+		SearchResult result = search.think(request->root, request->limits, request->history, onIteration);
+
+		if (cancelId.load() != id && !quit.load())
+			postReport({ id, true, std::move(result) }, true);
+	}
+}
@@ -0,0 +1,67 @@
+// EngineWorker.hpp
+// EngineWorker class
+// Runs searches on a background thread, so the caller's thread never waits on the engine
+
+#pragma once
+#include "Search.hpp"
+#include "SpscQueue.hpp"
+#include "TranspositionTable.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+struct EngineRequest {
+	std::uint32_t id = 0;
+	Position root;
+	SearchLimits limits;
+	std::vector<std::uint64_t> history; // Earlier game keys, for repetition detection
+};
+
+struct EngineReport {
+	std::uint32_t id = 0; // Request the report belongs to
+	bool finished = false; // False for an iteration update, true for the final result
+	SearchResult result;
+};
+
+// Requests go to the worker, and reports come back, through SPSC queues. The caller's thread is the only
+// producer of requests and the only consumer of reports, and the worker thread is the other end of both.
+class EngineWorker {
+private:
+	TranspositionTable tt; // Owned by the worker, only its search touches it
+	Search search;
+
+	SpscQueue<EngineRequest, 8> requests;
+	SpscQueue<EngineReport, 64> reports;
+
+	std::atomic<std::uint32_t> nextId{ 1 };
+	std::atomic<std::uint32_t> stopId{ 0 }; // Request that should stop and report its best move so far
+	std::atomic<std::uint32_t> cancelId{ 0 }; // Request that should stop without reporting
+	std::atomic<bool> quit{ false };
+
+	// Only used to sleep while there is nothing to search, never while a search runs
+	std::mutex idleMutex;
+	std::condition_variable idleWake;
+
+	std::thread thread; // Started last, after everything it uses is constructed
+
+	void run(); // Body of the worker thread
+	bool shouldStop(std::uint32_t id) const { return stopId.load() == id || cancelId.load() == id || quit.load(); }
+	void postReport(EngineReport report, bool mustDeliver);
+
+public:
+	EngineWorker(int threads = 1, std::size_t hashMb = 16); // Constructor, starts the worker thread
+	~EngineWorker(); // Cancels any search and joins the thread
+	EngineWorker(const EngineWorker&) = delete;
+	EngineWorker& operator=(const EngineWorker&) = delete;
+
+	// Queues a search and returns its id, or 0 if too many requests are already waiting
+	std::uint32_t startSearch(const Position& root, const SearchLimits& limits, const std::vector<std::uint64_t>& history = {});
+	void stop(std::uint32_t id); // Ends the search early, its best move so far is still reported
+	void cancel(std::uint32_t id); // Ends the search early and drops its result
+
+	std::optional<EngineReport> poll(); // Next report, never blocks
+};
@@ -0,0 +1,116 @@
+// Evaluate.cpp
+// Material and piece-square table evaluation, blended between middlegame and endgame king tables
+
+#include "Evaluate.hpp"
+
+// Piece-square tables from white's point of view, written with rank 8 on the first row
+static const int pawnTable[64] = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	 50,  50,  50,  50,  50,  50,  50,  50,
+	 10,  10,  20,  30,  30,  20,  10,  10,
+	  5,   5,  10,  25,  25,  10,   5,   5,
+	  0,   0,   0,  20,  20,   0,   0,   0,
+	  5,  -5, -10,   0,   0, -10,  -5,   5,
+	  5,  10,  10, -20, -20,  10,  10,   5,
+	  0,   0,   0,   0,   0,   0,   0,   0
+};
+
+static const int knightTable[64] = {
+	-50, -40, -30, -30, -30, -30, -40, -50,
+	-40, -20,   0,   0,   0,   0, -20, -40,
+	-30,   0,  10,  15,  15,  10,   0, -30,
+	-30,   5,  15,  20,  20,  15,   5, -30,
+	-30,   0,  15,  20,  20,  15,   0, -30,
+	-30,   5,  10,  15,  15,  10,   5, -30,
+	-40, -20,   0,   5,   5,   0, -20, -40,
+	-50, -40, -30, -30, -30, -30, -40, -50
+};
+
+static const int bishopTable[64] = {
+	-20, -10, -10, -10, -10, -10, -10, -20,
+	-10,   0,   0,   0,   0,   0,   0, -10,
+	-10,   0,   5,  10,  10,   5,   0, -10,
+	-10,   5,   5,  10,  10,   5,   5, -10,
+	-10,   0,  10,  10,  10,  10,   0, -10,
+	-10,  10,  10,  10,  10,  10,  10, -10,
+	-10,   5,   0,   0,   0,   0,   5, -10,
+	-20, -10, -10, -10, -10, -10, -10, -20
+};
+
+static const int rookTable[64] = {
+	  0,   0,   0,   0,   0,   0,   0,   0,
+	  5,  10,  10,  10,  10,  10,  10,   5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	 -5,   0,   0,   0,   0,   0,   0,  -5,
+	  0,   0,   0,   5,   5,   0,   0,   0
+};
+
+static const int queenTable[64] = {
+	-20, -10, -10,  -5,  -5, -10, -10, -20,
+	-10,   0,   0,   0,   0,   0,   0, -10,
+	-10,   0,   5,   5,   5,   5,   0, -10,
+	 -5,   0,   5,   5,   5,   5,   0,  -5,
+	  0,   0,   5,   5,   5,   5,   0,  -5,
+	-10,   5,   5,   5,   5,   5,   0, -10,
+	-10,   0,   5,   0,   0,   0,   0, -10,
+	-20, -10, -10,  -5,  -5, -10, -10, -20
+};
+
+static const int kingMiddleTable[64] = {
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-30, -40, -40, -50, -50, -40, -40, -30,
+	-20, -30, -30, -40, -40, -30, -30, -20,
+	-10, -20, -20, -20, -20, -20, -20, -10,
+	 20,  20,   0,   0,   0,   0,  20,  20,
+	 20,  30,  10,   0,   0,  10,  30,  20
+};
+
+static const int kingEndTable[64] = {
+	-50, -40, -30, -20, -20, -30, -40, -50,
+	-30, -20, -10,   0,   0, -10, -20, -30,
+	-30, -10,  20,  30,  30,  20, -10, -30,
+	-30, -10,  30,  40,  40,  30, -10, -30,
+	-30, -10,  30,  40,  40,  30, -10, -30,
+	-30, -10,  20,  30,  30,  20, -10, -30,
+	-30, -30,   0,   0,   0,   0, -30, -30,
+	-50, -30, -30, -30, -30, -30, -30, -50
+};
+
+static const int* const pieceTables[5] = { pawnTable, knightTable, bishopTable, rookTable, queenTable };
+
+// Table index for a square, tables list rank 8 first so white squares are mirrored
+static int tableIndex(Color c, int sq) { return c == White ? sq ^ 56 : sq; }
+
+int evaluate(const Position& position) {
+	int score[2] = { 0, 0 };
+	int phase = 0; // Non-pawn material left, 24 at the start and 0 with only kings and pawns
+
+	for (Color c : { White, Black }) {
+		for (int t = 0; t < 5; t++) {
+			Bitboard b = position.pieces(c, static_cast<PieceType>(t));
+			while (b) {
+				int sq = popLsb(b);
+				score[c] += PieceValues[t] + pieceTables[t][tableIndex(c, sq)];
+			}
+		}
+		phase += popCount(position.pieces(c, PieceType::Knight)) + popCount(position.pieces(c, PieceType::Bishop))
+			+ 2 * popCount(position.pieces(c, PieceType::Rook)) + 4 * popCount(position.pieces(c, PieceType::Queen));
+	}
+	if (phase > 24) phase = 24;
+
+	// King safety matters in the middlegame, king activity in the endgame
+	for (Color c : { White, Black }) {
+		int kingSq = position.kingSquare(c);
+		if (kingSq == -1) continue;
+		int idx = tableIndex(c, kingSq);
+		score[c] += (kingMiddleTable[idx] * phase + kingEndTable[idx] * (24 - phase)) / 24;
+	}
+
+	int whiteScore = score[White] - score[Black];
+	return position.sideToMove() == White ? whiteScore : -whiteScore;
+}
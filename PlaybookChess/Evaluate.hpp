@@ -0,0 +1,10 @@
+// Evaluate.hpp
+// Static evaluation for the engine
+
+#pragma once
+#include "Position.hpp"
+
+constexpr int PieceValues[6] = { 100, 320, 330, 500, 900, 0 }; // Pawn, Knight, Bishop, Rook, Queen, King in centipawns
+
+// Score in centipawns from the side to move's point of view
+int evaluate(const Position& position);
@@ -3,28 +3,73 @@
 // Game class functions
 
 #include "Game.hpp"
+#include "Bench.hpp"
+#include "Notation.hpp"
 #include <iostream>
 #include <optional> // An optional variable, does not have to store a value
 #include <algorithm>
-#include <memory>
+#include <chrono>
 
-Game::Game() : window(sf::VideoMode({ 800, 800 }), "Chess Board") // In line constructor for window
+static const auto sessionStart = std::chrono::steady_clock::now(); // Set during static initialization, as close to process start as portable code gets
+
+// Loads the atlas pixels without touching the window, so it can run on another thread
+static std::optional<sf::Image> loadAtlasImage() {
+	sf::Image atlas;
+	if (!loadPieceAtlasImage(atlas)) return std::nullopt;
+	return atlas;
+}
+
+Game::Game(const GameOptions& gameOptions) : atlasImage(std::async(std::launch::async, loadAtlasImage)), window(sf::VideoMode({ 800, 800 }), "Chess Board"), options(gameOptions), engine(gameOptions.engineThreads) // In line constructor for window and engine
 {
 	window.setFramerateLimit(60);
 
-	if (!loadPieceTextures()) {
+	std::optional<sf::Image> atlas = atlasImage.get(); // Texture upload needs the window's GL context, so it waits for both
+	if (!atlas || !loadPieceTextures(*atlas)) {
 		std::cerr << "ERROR: Could not load piece textures." << std::endl;
 		std::exit(-1);
 	}
 
-	if (!font.openFromFile("Typography Times Regular.ttf")) {
+	if (!loadFont(font)) {
 		std::cerr << "ERROR: Could not load font." << std::endl;
 		std::exit(-1);
 	}
 
+	if (!options.bookPath.empty() && !book.open(options.bookPath)) // The game is still playable without a book
+		std::cerr << "ERROR: Could not open book " << options.bookPath << std::endl;
+	if (!options.tablebasePath.empty() && tablebases.load(options.tablebasePath) == 0)
+		std::cerr << "ERROR: No tablebases found in " << options.tablebasePath << std::endl;
+
 	board.initialize(); // Initialize board, text, and pieces when game is constructed
 	initText();
 	initPieces();
+	renderStaticLayer();
+
+	if (!options.viewPath.empty()) {
+		if (archive.open(options.viewPath, &std::cout) && archive.size() > 0) {
+			viewing = true;
+			options.engineWhite = options.engineBlack = false;
+			showArchiveGame(options.viewGame > 0 ? options.viewGame - 1 : 0, options.viewPly);
+		}
+		else {
+			std::cerr << "ERROR: No games in " << options.viewPath << std::endl;
+		}
+	}
+	else if (!options.serverHost.empty()) {
+		connectToServer();
+	}
+}
+
+void Game::renderStaticLayer() {
+	if (!staticLayer.resize(window.getSize())) {
+		std::cerr << "ERROR: Could not create the board layer." << std::endl;
+		std::exit(-1);
+	}
+
+	staticLayer.clear(sf::Color(50, 50, 50));
+	board.drawSquares(staticLayer);
+	for (auto& r : rankText) staticLayer.draw(r); // Draw text using references
+	for (auto& f : fileText) staticLayer.draw(f);
+	staticLayer.display();
 }
 
 void Game::initText() {
@@ -60,40 +105,43 @@ void Game::initText() {
 void Game::initPieces() {
 	// Initialize pawns
 	for (int file = 1; file < 9; file++) {
-		pieces.push_back(std::make_unique<Piece>(file, 2, true, PieceType::Pawn, pieceTextures["white_pawn"]));
-		pieces.push_back(std::make_unique<Piece>(file, 7, false, PieceType::Pawn, pieceTextures["black_pawn"]));
+		pieces.add(file, 2, true, PieceType::Pawn);
+		pieces.add(file, 7, false, PieceType::Pawn);
 	}
 
 	// Rooks
-	pieces.push_back(std::make_unique<Piece>(1, 1, true, PieceType::Rook, pieceTextures["white_rook"]));
-	pieces.push_back(std::make_unique < Piece>(8, 1, true, PieceType::Rook, pieceTextures["white_rook"]));
-	pieces.push_back(std::make_unique<Piece>(1, 8, false, PieceType::Rook, pieceTextures["black_rook"]));
-	pieces.push_back(std::make_unique<Piece>(8, 8, false, PieceType::Rook, pieceTextures["black_rook"]));
+	pieces.add(1, 1, true, PieceType::Rook);
+	pieces.add(8, 1, true, PieceType::Rook);
+	pieces.add(1, 8, false, PieceType::Rook);
+	pieces.add(8, 8, false, PieceType::Rook);
 
 	// Knights
-	pieces.push_back(std::make_unique<Piece>(2, 1, true, PieceType::Knight, pieceTextures["white_knight"]));
-	pieces.push_back(std::make_unique<Piece>(7, 1, true, PieceType::Knight, pieceTextures["white_knight"]));
-	pieces.push_back(std::make_unique<Piece>(2, 8, false, PieceType::Knight, pieceTextures["black_knight"]));
-	pieces.push_back(std::make_unique<Piece>(7, 8, false, PieceType::Knight, pieceTextures["black_knight"]));
+	pieces.add(2, 1, true, PieceType::Knight);
+	pieces.add(7, 1, true, PieceType::Knight);
+	pieces.add(2, 8, false, PieceType::Knight);
+	pieces.add(7, 8, false, PieceType::Knight);
 
 	// Bishops
-	pieces.push_back(std::make_unique<Piece>(3, 1, true, PieceType::Bishop, pieceTextures["white_bishop"]));
-	pieces.push_back(std::make_unique<Piece>(6, 1, true, PieceType::Bishop, pieceTextures["white_bishop"]));
-	pieces.push_back(std::make_unique<Piece>(3, 8, false, PieceType::Bishop, pieceTextures["black_bishop"]));
-	pieces.push_back(std::make_unique<Piece>(6, 8, false, PieceType::Bishop, pieceTextures["black_bishop"]));
+	pieces.add(3, 1, true, PieceType::Bishop);
+	pieces.add(6, 1, true, PieceType::Bishop);
+	pieces.add(3, 8, false, PieceType::Bishop);
+	pieces.add(6, 8, false, PieceType::Bishop);
 
 	// Queens
-	pieces.push_back(std::make_unique<Piece>(4, 1, true, PieceType::Queen, pieceTextures["white_queen"]));
-	pieces.push_back(std::make_unique<Piece>(4, 8, false, PieceType::Queen, pieceTextures["black_queen"]));
+	pieces.add(4, 1, true, PieceType::Queen);
+	pieces.add(4, 8, false, PieceType::Queen);
 
 	// Kings
-	pieces.push_back(std::make_unique<Piece>(5, 1, true, PieceType::King, pieceTextures["white_king"]));
-	pieces.push_back(std::make_unique<Piece>(5, 8, false, PieceType::King, pieceTextures["black_king"]));
+	pieces.add(5, 1, true, PieceType::King);
+	pieces.add(5, 8, false, PieceType::King);
+
+	rules.reset(); // Rules start from the same standard position
+	piecesDirty = true;
 }
 
 std::optional<sf::Vector2i> Game::getSquareFromMouse(const sf::Vector2i& mousePos) {
-	float x = mousePos.x - 64.f;
-	float y = mousePos.y - 64.f;
+	float x = mousePos.x - boardOffset;
+	float y = mousePos.y - boardOffset;
 
 	if (x < 0 || y < 0) return std::nullopt; // Returns nullopt if mouse is outside of window
 
@@ -106,261 +154,535 @@ std::optional<sf::Vector2i> Game::getSquareFromMouse(const sf::Vector2i& mousePo
 	return sf::Vector2i(file, rank); // Returns the file and rank of the mouse
 }
 
-bool Game::isKingInCheck(bool whiteKing) {
-	int kingFile = -1, kingRank = -1;
+void Game::updatePieces(const Move& move) {
+	int fromFile = fileOf(move.from()), fromRank = rankOf(move.from());
+	int toFile = fileOf(move.to()), toRank = rankOf(move.to());
+	int capFile = toFile, capRank = move.flag() == MoveFlag::EnPassant ? fromRank : toRank; // En passant captures beside the moving pawn
+
+	// Remove the captured piece, only its alive bit changes
+	int captured = pieces.slotAt(capFile, capRank);
+	if (captured != -1) pieces.capture(captured);
 
-	// Find the king
-	for (const auto& p : pieces) {
-		if (p->getType() == PieceType::King && p->isWhitePiece() == whiteKing) {
-			kingFile = p->getFile();
-			kingRank = p->getRank();
+	int mover = pieces.slotAt(fromFile, fromRank);
+	if (mover != -1) {
+		pieces.move(mover, toFile, toRank);
+		if (move.flag() == MoveFlag::Promotion) pieces.promote(mover, move.promotion()); // The pawn's slot becomes the promoted piece
+	}
+
+	if (move.flag() == MoveFlag::Castling) { // Move the rook beside the king
+		int rook = pieces.slotAt(toFile == 7 ? 8 : 1, toRank);
+		if (rook != -1) pieces.move(rook, toFile == 7 ? 6 : 4, toRank);
+	}
+	piecesDirty = true;
+}
+
+void Game::drawPieces() {
+	if (piecesDirty) {
+		pieceVertices.clear();
+		pieces.appendVertices(pieceVertices);
+		piecesDirty = false;
+	}
+	window.draw(pieceVertices, &pieceAtlas);
+}
+
+void Game::playMove(const Move& move) {
+	needsRedraw = true;
+	bool moverIsWhite = rules.whiteToMove();
+	MoveResult result = rules.applyMove(move);
+	updatePieces(move);
+	showMoveResult(result, moverIsWhite);
+}
+
+void Game::submitMove(const Move& move) {
+	if (!server.isConnected()) {
+		playMove(move);
+		return;
+	}
+
+	// The board only changes when the server echoes the move back, so both windows apply it the same way
+	NetMessage message;
+	message.type = NetMessageType::PlayMove;
+	message.gameId = onlineGameId;
+	message.move = move;
+	awaitingServer = server.send(message);
+	board.clearMoveHints();
+	needsRedraw = true;
+}
+
+bool Game::isRemoteTurn() const {
+	if (!server.isConnected()) return false;
+	return !onlineStarted || awaitingServer || !onlineWhite || *onlineWhite != whiteTurn;
+}
+
+void Game::connectToServer() {
+	if (!server.connect(options.serverHost, options.serverPort)) { // The game is still playable locally
+		std::cerr << "ERROR: Could not connect to " << options.serverHost << ":" << options.serverPort << ", playing locally" << std::endl;
+		return;
+	}
+
+	NetMessage message;
+	if (options.joinGameId != 0) {
+		message.type = NetMessageType::Join;
+		message.gameId = options.joinGameId;
+	}
+	else {
+		message.type = NetMessageType::Create;
+		message.code = static_cast<std::uint8_t>(NetSide::White);
+	}
+	server.send(message);
+}
+
+void Game::pollServer() {
+	if (!server.isConnected()) return;
+	while (std::optional<NetMessage> message = server.poll()) {
+		switch (message->type) {
+		case NetMessageType::Created:
+		case NetMessageType::Joined:
+			onlineGameId = message->gameId;
+			onlineWhite = message->code == static_cast<std::uint8_t>(NetSide::White);
+			if (message->type == NetMessageType::Created)
+				std::cout << "Created game " << onlineGameId << ", the opponent joins with --join " << onlineGameId << std::endl;
+			break;
+		case NetMessageType::Started:
+			if (message->gameId != onlineGameId) break;
+			onlineStarted = true;
+			std::cout << "Game " << onlineGameId << " started, you play " << (*onlineWhite ? "White" : "Black") << std::endl;
+			break;
+		case NetMessageType::Moved:
+			if (message->gameId != onlineGameId) break;
+			awaitingServer = false;
+			board.clearHighlights();
+			selectedPiece.reset();
+			playMove(message->move); // Already checked by the same rules on the server
+			break;
+		case NetMessageType::Rejected:
+			awaitingServer = false;
+			std::cout << (onlineStarted ? "Server rejected the move: " : "Could not join the game: ")
+				<< rejectReason(static_cast<NetReject>(message->code)) << std::endl;
+			break;
+		case NetMessageType::Ended:
+			std::cout << "Opponent left the game." << std::endl;
+			gameOver = true;
+			break;
+		default:
 			break;
 		}
 	}
+	if (!server.isConnected()) {
+		std::cerr << "ERROR: Lost the connection to the server" << std::endl;
+		gameOver = true;
+	}
+}
 
-	if (kingFile == -1) std::cerr << "ERROR: King not found in King in Check function" << std::endl;
+void Game::showMoveResult(const MoveResult& result, bool moverIsWhite) {
+	std::cout << result.notation << std::endl;
+	board.clearMoveHints();
+	hoveredSquare.reset(); // Hints come back once the mouse moves over a piece of the new side to move
 
-	// Check if king is threatened
-	for (const auto& p : pieces) {
-		if (p->isWhitePiece() != whiteKing) {
-			if (p->isValidMove(kingFile, kingRank, pieces)) {
-				return true;
-			}
-		}
+	board.setMoveSquare(fileOf(result.move.to()), rankOf(result.move.to()));
+	whiteTurn = !whiteTurn; // Alternate turns
+
+	// Find opponent king
+	int kingSq = rules.getPosition().kingSquare(moverIsWhite ? Black : White);
+	int kingFile = kingSq == -1 ? -1 : fileOf(kingSq);
+	int kingRank = kingSq == -1 ? -1 : rankOf(kingSq);
+
+	// Check for checkmate, stalemate, and check
+	if (result.result == GameResult::WhiteWins || result.result == GameResult::BlackWins) {
+		std::cout << (moverIsWhite ? "White" : "Black") << " wins by checkmate." << std::endl;
+		if (kingFile != -1) board.setCheckmateHighlight(kingFile, kingRank);
+		gameOver = true;
+	}
+	else if (result.result == GameResult::Stalemate) {
+		std::cout << "Draw by stalemate." << std::endl;
+		gameOver = true;
 	}
-	return false;
+	else if (result.result == GameResult::Repetition) {
+		std::cout << "Draw by threefold repetition." << std::endl;
+		gameOver = true;
+	}
+	else if (result.givesCheck) {
+		if (kingFile != -1) board.setCheckHighlight(kingFile, kingRank);
+	}
+
+	showTablebaseResult();
+	showBookMoves();
 }
 
-bool Game::isCheckmate(bool whiteKing) {
-	int kingFile = -1;
-	int kingRank = -1;
+bool Game::engineShouldStart() const {
+	return !gameOver && isEngineTurn() && !isRemoteTurn() && pendingSearch == 0 && !rules.canRedo(); // After a takeback the engine waits while moves can be replayed
+}
 
-	// Find King location
-	for (auto& p : pieces) {
-		if (p->getType() == PieceType::King && p->isWhitePiece() == whiteKing) {
-			kingFile = p->getFile();
-			kingRank = p->getRank();
-		}
+void Game::syncPieces(const Position& position) {
+	pieces.clear();
+	for (int sq = 0; sq < 64; sq++) {
+		PieceCode code = position.pieceOn(sq);
+		if (code != NoPiece) pieces.add(fileOf(sq), rankOf(sq), colorOf(code) == White, typeOf(code));
 	}
+	piecesDirty = true;
+}
 
-	// Check if King is in check at all
-	if (!isKingInCheck(whiteKing)) return false;
+void Game::takeBack() {
+	if (!rules.canUndo() || server.isConnected()) return; // Online games only move forward
+	if (pendingSearch != 0) { // The search was for the position being taken back
+		engine.cancel(pendingSearch);
+		pendingSearch = 0;
+	}
 
-	// Iterate through all possible moves
-	for (int i = 0; i <= pieces.size(); i++) {
-		auto& p = pieces[i];
-		if (p->isWhitePiece() != whiteKing) continue;
-		int origFile = p->getFile();
-		int origRank = p->getRank();
+	rules.undoMove();
+	whiteTurn = rules.whiteToMove();
+	if (isEngineTurn() && !(options.engineWhite && options.engineBlack) && rules.canUndo()) { // Take back the engine's reply too, so the player is to move again
+		rules.undoMove();
+		whiteTurn = rules.whiteToMove();
+	}
+	gameOver = rules.isGameOver();
+	std::cout << "Takeback, " << (whiteTurn ? "White" : "Black") << " to move" << std::endl;
+	showPosition();
+}
 
-		for (int file = 1; file <= 8; file++) {
-			for (int rank = 1; rank <= 8; rank++) {
-				if (file == origFile && rank == origRank) continue;
-				if (!p->isValidMove(file, rank, pieces)) continue;
+void Game::replayMove() {
+	if (!rules.canRedo() || server.isConnected()) return;
+	if (pendingSearch != 0) {
+		engine.cancel(pendingSearch);
+		pendingSearch = 0;
+	}
 
-				// Simulate move
-				std::unique_ptr<Piece> capturedPiece = nullptr;
-				int capturedIndex = -1;
+	bool moverIsWhite = rules.whiteToMove();
+	std::optional<MoveResult> result = rules.redoMove();
+	std::cout << "Replay: ";
+	updatePieces(result->move);
+	board.clearHighlights();
+	selectedPiece.reset();
+	showMoveResult(*result, moverIsWhite);
+	needsRedraw = true;
+}
 
-				for (auto x = pieces.begin(); x != pieces.end(); x++) {
-					if ((*x)->getFile() == file && (*x)->getRank() == rank && (*x)->isWhitePiece() != p->isWhitePiece()) {
-						capturedIndex = std::distance(pieces.begin(), x);
-						capturedPiece = std::move(*x);
-						pieces.erase(x);
-						break;
-					}
-				}
+void Game::showPosition() {
+	syncPieces(rules.getPosition());
+	board.clearHighlights();
+	selectedPiece.reset();
+	if (std::optional<Move> last = rules.lastMove())
+		board.setMoveSquare(fileOf(last->to()), rankOf(last->to()));
+	int kingSq = rules.getPosition().kingSquare(whiteTurn ? White : Black);
+	if (kingSq != -1 && rules.isKingInCheck(whiteTurn))
+		board.setCheckHighlight(fileOf(kingSq), rankOf(kingSq));
+	needsRedraw = true;
+
+	showTablebaseResult();
+	showBookMoves();
+}
 
-				int adjustedIndex = i;
-				if (capturedIndex != -1 && static_cast<int>(capturedIndex) < i) --adjustedIndex;
-				if (adjustedIndex >= pieces.size()) continue;
+void Game::showArchiveGame(std::size_t game, int ply) {
+	viewedGame = std::min(game, archive.size() - 1);
+	if (!replay.load(archive, viewedGame))
+		std::cerr << "ERROR: Game " << viewedGame + 1 << " has an invalid start position" << std::endl;
 
-				// Move piece
-				pieces[adjustedIndex]->setPosition(file, rank);
+	std::cout << "Game " << viewedGame + 1 << " of " << archive.size() << ": " << archive.tag(viewedGame, PgnTag::White) << " - "
+		<< archive.tag(viewedGame, PgnTag::Black) << " " << archive.tag(viewedGame, PgnTag::Result) << " ("
+		<< archive.tag(viewedGame, PgnTag::Event) << ", " << archive.tag(viewedGame, PgnTag::Date) << "), " << replay.plyCount() << " plies" << std::endl;
+	if (!replay.getError().empty()) std::cout << "Replay stops early: " << replay.getError() << std::endl;
 
-				// Check if king is in check
-				bool inCheck = isKingInCheck(whiteKing);
+	replay.seek(ply);
+	syncPieces(replay.position());
+	showReplayPosition();
+}
 
-				// Undo simulated piece move
-				pieces[adjustedIndex]->setPosition(origFile, origRank);
+void Game::stepReplay(int plies) {
+	int target = std::clamp(replay.currentPly() + plies, 0, replay.plyCount());
+	if (target == replay.currentPly()) return;
 
-				// Replace captured piece if applicable
-				if (capturedPiece && capturedIndex != -1) {
-					pieces.insert(pieces.begin() + capturedIndex, std::move(capturedPiece));
-				}
+	if (target == replay.currentPly() + 1) { // The common case, same incremental update as a played move
+		Position before = replay.position();
+		Move move = replay.moveAt(replay.currentPly());
+		std::cout << before.fullmoves() << (before.sideToMove() == White ? ". " : "... ") << moveToSan(before, move) << std::endl;
+		replay.forward();
+		updatePieces(move);
+	}
+	else { // Anything else starts from the nearest checkpoint
+		replay.seek(target);
+		syncPieces(replay.position());
+		std::cout << "Ply " << replay.currentPly() << " of " << replay.plyCount() << std::endl;
+	}
+	showReplayPosition();
+}
 
-				if (!inCheck) return false;
-			}
-		}
+void Game::showReplayPosition() {
+	const Position& position = replay.position();
+	board.clearHighlights();
+	selectedPiece.reset();
+	whiteTurn = position.sideToMove() == White;
+
+	if (replay.currentPly() > 0) {
+		Move last = replay.moveAt(replay.currentPly() - 1);
+		board.setMoveSquare(fileOf(last.to()), rankOf(last.to()));
+	}
+	int kingSq = position.kingSquare(position.sideToMove());
+	if (kingSq != -1 && position.checkers() != 0)
+		board.setCheckHighlight(fileOf(kingSq), rankOf(kingSq));
+	needsRedraw = true;
+}
+
+void Game::handleViewerKey(sf::Keyboard::Key key) {
+	constexpr std::size_t GamesPerPage = 100;
+	switch (key) {
+	case sf::Keyboard::Key::Right: stepReplay(1); break;
+	case sf::Keyboard::Key::Left: stepReplay(-1); break;
+	case sf::Keyboard::Key::Home: stepReplay(-replay.plyCount()); break;
+	case sf::Keyboard::Key::End: stepReplay(replay.plyCount()); break;
+	case sf::Keyboard::Key::Down: showArchiveGame(viewedGame + 1, 0); break;
+	case sf::Keyboard::Key::Up: showArchiveGame(viewedGame > 0 ? viewedGame - 1 : 0, 0); break;
+	case sf::Keyboard::Key::PageDown: showArchiveGame(viewedGame + GamesPerPage, 0); break;
+	case sf::Keyboard::Key::PageUp: showArchiveGame(viewedGame > GamesPerPage ? viewedGame - GamesPerPage : 0, 0); break;
+	default: break;
 	}
+}
+
+bool Game::isEngineTurn() const {
+	return whiteTurn ? options.engineWhite : options.engineBlack;
+}
+
+bool Game::playBookMove() {
+	if (!book.isOpen()) return false;
+	Position position = rules.getPosition();
+	std::optional<Move> bookMove = book.pick(position, bookRng);
+	if (!bookMove) return false;
 
+	// Same lookup a click uses, then the book's promotion piece
+	std::optional<Move> move = rules.findMove(fileOf(bookMove->from()), rankOf(bookMove->from()), fileOf(bookMove->to()), rankOf(bookMove->to()));
+	if (!move) return false;
+	move->setPromotion(bookMove->promotion());
+
+	std::cout << (whiteTurn ? "White" : "Black") << " plays from book" << std::endl;
+	board.clearHighlights();
+	selectedPiece.reset();
+	submitMove(*move);
+	return true;
+}
+
+void Game::showBookMoves() {
+	if (!book.isOpen() || gameOver || isEngineTurn()) return;
+	Position position = rules.getPosition();
+	std::vector<BookMove> moves = book.probe(position);
+	if (moves.empty()) return;
+
+	std::uint32_t total = 0;
+	for (const BookMove& m : moves) total += m.weight;
+	std::cout << "Book:";
+	for (const BookMove& m : moves)
+		std::cout << " " << moveToSan(position, m.move) << " " << (total ? 100 * m.weight / total : 0) << "%";
+	std::cout << std::endl;
+}
+
+bool Game::playTablebaseMove() {
+	if (tablebases.size() == 0) return false;
+	Position position = rules.getPosition();
+	Move best;
+	if (!tablebases.bestMove(position, best)) return false;
+
+	std::optional<Move> move = rules.findMove(fileOf(best.from()), rankOf(best.from()), fileOf(best.to()), rankOf(best.to()));
+	if (!move) return false;
+	move->setPromotion(best.promotion());
+
+	std::cout << (whiteTurn ? "White" : "Black") << " plays from tablebase" << std::endl;
+	board.clearHighlights();
+	selectedPiece.reset();
+	submitMove(*move);
 	return true;
 }
 
-// Convert file/rank to chess notation
-static std::string toNotation(int file, int rank) {
-	std::string notation;
-	notation += static_cast<char>('a' + file - 1);
-	notation += std::to_string(rank);
-	return notation;
+void Game::showTablebaseResult() {
+	if (tablebases.size() == 0 || gameOver) return;
+	std::optional<TbResult> result = tablebases.probe(rules.getPosition());
+	if (!result) return;
+
+	if (result->outcome == TbOutcome::Draw) {
+		std::cout << "Tablebase: draw" << std::endl;
+		return;
+	}
+	bool whiteWins = (result->outcome == TbOutcome::Win) == whiteTurn;
+	std::cout << "Tablebase: " << (whiteWins ? "White" : "Black") << " mates in " << result->movesToMate() << std::endl;
+}
+
+void Game::startEngineSearch() {
+	SearchLimits limits;
+	limits.movetimeMs = options.engineMoveTimeMs;
+	limits.depth = options.engineDepth;
+	pendingSearch = engine.startSearch(rules.getPosition(), limits, rules.getKeyHistory());
 }
 
-// Convert piece type to notation
-static std::string pieceSymbol(PieceType type) {
-	switch (type) {
-	case PieceType::King:	return "K";
-	case PieceType::Queen:	return "Q";
-	case PieceType::Rook:	return "R";
-	case PieceType::Bishop:	return "B";
-	case PieceType::Knight:	return "N";
-	default:				return "";
+void Game::pollEngine() {
+	while (std::optional<EngineReport> report = engine.poll()) {
+		if (report->id != pendingSearch || !report->finished) continue; // Only the final result of the current search matters here
+		pendingSearch = 0;
+
+		const SearchResult& result = report->result;
+		if (!result.hasMove) return;
+		std::cout << (whiteTurn ? "White" : "Black") << " engine: depth " << result.depth << ", score " << result.score
+			<< ", " << result.nodes << " nodes in " << result.seconds << " s" << std::endl;
+		board.clearHighlights();
+		selectedPiece.reset();
+		submitMove(result.bestMove);
 	}
 }
 
 void Game::handleClick(int file, int rank) {
-	if (gameOver) return;
-
-	char files[8] = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h' };
+	if (viewing || gameOver || isEngineTurn() || isRemoteTurn()) return; // Clicks are ignored while the engine or the other window has the move
+	needsRedraw = true; // Selection and highlights change on every accepted click
 
 	if (!selectedPiece.has_value()) { // No piece selected yet
-		for (int i = 0; i < pieces.size(); i++) {
-			auto& tempP = pieces[i];
-			if (tempP->getFile() == file && tempP->getRank() == rank && tempP->isWhitePiece() == whiteTurn) {
-				board.clearHighlights();
-				selectedPiece = i;
-				board.setSelectedSquare(file, rank);
-				std::cout << (whiteTurn ? "White" : "Black") << " selects " << pieceSymbol(pieces[i]->getType()) << toNotation(file, rank) << std::endl;
-			}
-		}
+		selectPiece(file, rank);
 		return;
 	}
 
-	// Try to move piece
-	if (!selectedPiece.has_value()) return;
-	int index = selectedPiece.value();
-	if (index >= pieces.size()) { selectedPiece.reset(); return; }
-	Piece* piece = pieces[index].get();
-	if (!piece) { selectedPiece.reset(); return; }
-
-	if (piece->isValidMove(file, rank, pieces)) {
-		// Simulate the move
-		int oldFile = piece->getFile();
-		int oldRank = piece->getRank();
-
-		// Temporarily capture piece until validity is checked
-		std::unique_ptr<Piece> capturedPiece = nullptr;
-		bool isCapture = false;
-		int capturedIndex = -1;
-
-		for (auto captPiece = pieces.begin(); captPiece != pieces.end(); captPiece++) {
-			if ((*captPiece)->getFile() == file && (*captPiece)->getRank() == rank && (*captPiece)->isWhitePiece() != piece->isWhitePiece()) {
-				capturedIndex = std::distance(pieces.begin(), captPiece);
-				capturedPiece = std::move(*captPiece);
-				pieces.erase(captPiece);
-				isCapture = true;
-				break;
-			}
-		}
+	// Try to move piece, the slot cannot have gone stale since captures never move other pieces' slots
+	int slot = selectedPiece.value();
+	selectedPiece.reset();
+	hoveredSquare.reset();
+	board.clearMoveHints();
+	if (!pieces.isAlive(slot)) return;
+	Piece piece = pieces.piece(slot);
+	if (piece.getFile() == file && piece.getRank() == rank) return; // Clicking the selected piece again deselects it
+
+	// Destinations were generated with the position, so an illegal click is a lookup
+	if (rules.legalDestinations(piece.getFile(), piece.getRank()) & squareBB(square(file, rank))) {
+		submitMove(*rules.findMove(piece.getFile(), piece.getRank(), file, rank));
+	}
+	else if (!selectPiece(file, rank)) { // Clicking another of the player's pieces switches to it
+		bool pinnedOrInCheck = piece.isValidMove(file, rank, rules.getPosition());
+		std::cout << (pinnedOrInCheck ? "Illegal move, King in check" : "Illegal move") << std::endl;
+	}
+}
+
+bool Game::selectPiece(int file, int rank) {
+	int slot = pieces.slotAt(file, rank);
+	if (slot == -1 || pieces.isWhitePiece(slot) != whiteTurn) return false;
+
+	board.clearHighlights();
+	selectedPiece = slot;
+	board.setSelectedSquare(file, rank);
+	Bitboard targets = rules.legalDestinations(file, rank);
+	board.setMoveHints(targets, targets & rules.getPosition().occupied());
+	std::cout << (whiteTurn ? "White" : "Black") << " selects " << pieceSymbol(pieces.getType(slot)) << toNotation(file, rank) << std::endl;
+	return true;
+}
 
-		if (isCapture && capturedIndex != -1 && static_cast<int>(capturedIndex) < index)
-			--index;
+void Game::handleHover(std::optional<sf::Vector2i> square) {
+	std::optional<int> hovered;
+	if (square) hovered = (square->y - 1) * 8 + square->x - 1;
+	if (hovered == hoveredSquare) return; // Only crossing into another square can change the hints
+	hoveredSquare = hovered;
+	if (viewing || selectedPiece || gameOver || isEngineTurn() || isRemoteTurn()) return; // A selection keeps its own hints
+
+	int slot = square ? pieces.slotAt(square->x, square->y) : -1;
+	if (slot != -1 && pieces.isWhitePiece(slot) == whiteTurn) {
+		Bitboard targets = rules.legalDestinations(square->x, square->y);
+		board.setMoveHints(targets, targets & rules.getPosition().occupied());
+	}
+	else {
+		board.clearMoveHints();
+	}
+	needsRedraw = true;
+}
 
-		pieces[index]->setPosition(file, rank);
+void Game::handleEvent(const sf::Event& event) {
+	if (event.is<sf::Event::Closed>()) // Close window if user closes it
+		window.close();
 
-		// Check legality of move
-		bool inCheck = isKingInCheck(piece->isWhitePiece());
+	if (event.is<sf::Event::Resized>() || event.is<sf::Event::FocusGained>()) // The window contents may have been lost
+		needsRedraw = true;
 
-		if (inCheck) {
-			std::cout << "Illegal move, King in check" << std::endl;
-			pieces[index]->setPosition(oldFile, oldRank); // Reset position
-			if (isCapture && capturedPiece)
-				pieces.insert(pieces.begin() + capturedIndex, std::move(capturedPiece)); // Replaces captured piece
-		}
-		else {
-			std::string moveNotation; // Build notation
-			moveNotation += pieceSymbol(piece->getType());
-			if (isCapture) {
-				if (piece->getType() == PieceType::Pawn)
-					moveNotation = std::string(1, static_cast<char>('a' + oldFile - 1));
-				moveNotation += "x"; // Add x to notation for a capture
-			}
-			moveNotation += toNotation(file, rank);
-
-			// Check if opponent is in check after move
-			bool opponentIsWhite = !piece->isWhitePiece();
-			bool opponentInCheck = isKingInCheck(opponentIsWhite);
-			if (opponentInCheck) moveNotation += "+";
-			std::cout << moveNotation << std::endl;
-
-			board.setMoveSquare(file, rank);
-			whiteTurn = !whiteTurn; // Alternate turns
-			
-
-			// Find opponent king
-			int kingFile = -1, kingRank = -1;
-			for (const auto& k : pieces) {
-				if (k->getType() == PieceType::King && k->isWhitePiece() == opponentIsWhite) {
-					kingFile = k->getFile();
-					kingRank = k->getRank();
-					break;
-				}
-			}
-
-			// Check for checkmate and check
-			if (isCheckmate(opponentIsWhite)) {
-				std::cout << (piece->isWhitePiece() ? "White" : "Black") << " wins by checkmate." << std::endl;
-				if (kingFile != -1) board.setCheckmateHighlight(kingFile, kingRank);
-				gameOver = true;
-			}
-			else if (opponentInCheck) {
-				if (kingFile != -1) board.setCheckHighlight(kingFile, kingRank);
-			}
+	if (const auto* mousePressed = event.getIf<sf::Event::MouseButtonPressed>()) { // Checks if user left clicks on square, then handles the click
+		if (mousePressed->button == sf::Mouse::Button::Left) {
+			if (gameOver) return; // Ignore inputs once game is over
+
+			// Convert mouse position to rank and file
+			if (std::optional<sf::Vector2i> clicked = getSquareFromMouse(mousePressed->position))
+				handleClick(clicked->x, clicked->y);
 		}
 	}
-	else {
-		std::cout << "Illegal move" << std::endl;
+
+	if (const auto* mouseMoved = event.getIf<sf::Event::MouseMoved>())
+		handleHover(getSquareFromMouse(mouseMoved->position));
+
+	if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>()) {
+		if (viewing) // Keys browse the archive instead
+			handleViewerKey(keyPressed->code);
+		else if (keyPressed->code == sf::Keyboard::Key::Space && pendingSearch != 0) // Engine moves now with its best move so far
+			engine.stop(pendingSearch);
+		else if (keyPressed->code == sf::Keyboard::Key::Space && isEngineTurn()) // Engine plays its own move instead of waiting for a replay
+			rules.clearRedo();
+		else if (keyPressed->code == sf::Keyboard::Key::Left || keyPressed->code == sf::Keyboard::Key::Backspace)
+			takeBack();
+		else if (keyPressed->code == sf::Keyboard::Key::Right)
+			replayMove();
 	}
+}
 
-	selectedPiece.reset();
+void Game::render() {
+	auto start = std::chrono::steady_clock::now();
+
+	window.draw(sf::Sprite(staticLayer.getTexture())); // Covers the whole window, so no clear is needed
+	board.draw(window);
+	drawPieces();
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	frameStats.framesDrawn++;
+	frameStats.totalDrawMs += ms;
+	frameStats.maxDrawMs = std::max(frameStats.maxDrawMs, ms);
+
+	window.display();
+	needsRedraw = false;
+
+	if (frameStats.framesDrawn == 1)
+		frameStats.firstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sessionStart).count();
+}
+
+void Game::printStats() const {
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - sessionStart).count();
+	double cpu = processCpuSeconds();
+	std::cout << "Startup: " << frameStats.firstFrameMs << " ms to first frame" << std::endl;
+	std::cout << "Frames drawn: " << frameStats.framesDrawn << " in " << wall << " s ("
+		<< (options.continuousRedraw ? "continuous" : "on change") << " redraw)" << std::endl;
+	if (frameStats.framesDrawn > 0)
+		std::cout << "Frame time: " << frameStats.totalDrawMs / frameStats.framesDrawn << " ms average, "
+			<< frameStats.maxDrawMs << " ms max" << std::endl;
+	std::cout << "CPU: " << cpu << " s, " << (wall > 0 ? 100.0 * cpu / wall : 0.0) << "% of one core" << std::endl;
 }
 
 void Game::run() {
-	// While loop that runs every frame
+	showTablebaseResult();
+	showBookMoves();
+
+	// While loop that runs once per batch of events
 	while (window.isOpen()) {
-		while (const std::optional event = window.pollEvent()) {
-			if (event->is<sf::Event::Closed>()) // Close window if user closes it
-				window.close();
-
-			if (const auto* mousePressed = event->getIf<sf::Event::MouseButtonPressed>()) { // Checks if user left clicks on square, then handles the click
-				if (mousePressed->button == sf::Mouse::Button::Left) {
-					if (gameOver) continue; // Ignore inputs once game is over
-
-					// Get mouse position
-					sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-
-					// Convert mouse position to rank and file
-					float x = mousePos.x - 64.f;
-					float y = mousePos.y - 64.f;
-					
-					if (x >= 0 && y >= 0) {
-						int file = static_cast<int>(x / squareSize) + 1;
-						int rank = static_cast<int>(y / squareSize) + 1;
-
-						if (file >= 1 && file <= 8 && rank >= 1 && rank <= 8) {
-							handleClick(file, rank);
-						}
-					}
-				}
-			}
+		// Sleep until an event arrives unless a frame is owed or the engine has to be asked for a move.
+		// While the engine thinks or a server is connected, the sleep is cut short so moves are picked up promptly.
+		bool busy = needsRedraw || options.continuousRedraw || engineShouldStart();
+		if (!busy) {
+			bool waiting = pendingSearch != 0 || server.isConnected(); // Engine and server replies arrive outside the event queue
+			std::optional<sf::Event> event = waiting ? window.waitEvent(sf::milliseconds(10)) : window.waitEvent();
+			if (event) handleEvent(*event);
 		}
+		while (const std::optional event = window.pollEvent())
+			handleEvent(*event);
+		if (!window.isOpen()) break;
 
-		window.clear(sf::Color(50, 50, 50));
-		board.draw(window);
+		pollEngine();
+		pollServer();
 
-		for (auto& r : rankText) window.draw(r); // Draw text and pieces using references
-		for (auto& f : fileText) window.draw(f);
-		for (auto& p : pieces) p->draw(window);
+		if (needsRedraw || options.continuousRedraw)
+			render();
 
-		window.display();
+		if (options.startupBenchmark) {
+			std::cout << "Startup: " << frameStats.firstFrameMs << " ms to first frame" << std::endl;
+			window.close();
+			break;
+		}
+
+		// Engine starts after the frame is shown, and the window keeps handling events while it thinks
+		if (engineShouldStart() && !playTablebaseMove() && !playBookMove())
+			startEngineSearch();
 	}
+
+	if (options.showStats) printStats();
 }
\ No newline at end of file
@@ -4,26 +4,117 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include "Board.hpp"
-#include "Piece.hpp"
+#include "PieceTable.hpp"
+#include "Rules.hpp"
 #include "Rendering.hpp"
+#include "Book.hpp"
+#include "EngineWorker.hpp"
+#include "Tablebase.hpp"
+#include "NetClient.hpp"
+#include "PgnArchive.hpp"
+#include <future>
+#include <optional>
+#include <random>
+#include <string>
 #include <vector>
 
+// Which sides the engine plays and how long it thinks
+struct GameOptions {
+	bool engineWhite = false;
+	bool engineBlack = false;
+	int engineMoveTimeMs = 1000;
+	int engineDepth = MaxPly - 1;
+	int engineThreads = 1;
+	std::string bookPath; // Polyglot-format opening book, none if empty
+	std::string tablebasePath; // Directory of .tb endgame tables, none if empty
+	bool continuousRedraw = false; // Redraw every frame at the frame limit instead of only after a change, for comparing costs
+	bool showStats = false; // Print frame time and CPU usage when the window closes
+	bool startupBenchmark = false; // Print the time from process start to the first frame, then quit
+	std::string serverHost; // Game server to play on, local play if empty
+	unsigned short serverPort = DefaultServerPort;
+	std::uint32_t joinGameId = 0; // Server game to join as black, 0 creates a new game as white
+	std::string viewPath; // PGN file to browse instead of playing, indexed on first open
+	std::size_t viewGame = 1; // First game shown, counted from 1
+	int viewPly = 0; // Ply of that game shown first
+};
+
+// Rendering cost over a session
+struct FrameStats {
+	int framesDrawn = 0;
+	double totalDrawMs = 0.0; // Time spent building and submitting frames, excludes waiting in display
+	double maxDrawMs = 0.0;
+	double firstFrameMs = 0.0; // Process start to the first displayed frame
+};
+
 class Game {
 private:
+	std::future<std::optional<sf::Image>> atlasImage; // Declared before window, so the atlas loads while the window is created
 	sf::RenderWindow window; // Game window
 	sf::Font font; // Rank and file text font
 	Board board; // Board class
-	std::vector<std::unique_ptr<Piece>> pieces; // Pieces vector, uses unique_ptr so pointers do not move when pieces are captured and removed from the vector
+	PieceTable pieces; // Drawn pieces in fixed slots, a selected slot stays valid through captures
+	sf::VertexArray pieceVertices{ sf::PrimitiveType::Triangles }; // Textured quads for every piece, drawn with the atlas in one call
+	bool piecesDirty = true; // Pieces moved since pieceVertices was last built
+	Rules rules; // Headless rules engine, the pieces vector only mirrors its position for drawing
 	std::vector<sf::Text> rankText; // Rank text vector
 	std::vector<sf::Text> fileText; // File text vector
-	std::optional<int> selectedPiece; // Currently selected piece
+	std::optional<int> selectedPiece; // Slot of the currently selected piece
+	std::optional<int> hoveredSquare; // Square under the mouse while nothing is selected, move hints follow it
 	bool whiteTurn = true; // White starts
+	GameOptions options;
+	EngineWorker engine; // Searches on its own thread, keeps its hash table between moves
+	std::uint32_t pendingSearch = 0; // Id of the engine search in progress, 0 if none
+	OpeningBook book; // Memory mapped, only the entries for positions actually probed are read
+	std::mt19937_64 bookRng{ std::random_device{}() };
+	Tablebases tablebases; // Memory mapped endgame tables, probed once few pieces are left
+	NetClient server; // Connected only for online play, then every move goes through the server
+	std::uint32_t onlineGameId = 0; // Server's id for this game, 0 until created or joined
+	std::optional<bool> onlineWhite; // Side this window plays online, empty until the server assigns it
+	bool onlineStarted = false; // Both seats are taken
+	bool awaitingServer = false; // A move was sent and the server has not answered yet
+	PgnArchive archive; // Memory mapped PGN file and its index, only the viewed game is ever parsed
+	GameReplay replay; // Viewed game, with positions cached at checkpoints for stepping back
+	std::size_t viewedGame = 0;
+	bool viewing = false; // Browsing the archive, the board only follows the replay
+
+	sf::RenderTexture staticLayer; // Background, squares, and coordinate text, rendered once
+	bool needsRedraw = true; // Set whenever visible state changes, the loop sleeps in waitEvent otherwise
+	FrameStats frameStats;
 
 	std::optional<sf::Vector2i> getSquareFromMouse(const sf::Vector2i& mousePos); // Gets the square the mouse clicks on by taking the position as an integer vector
 	void handleClick(int file, int rank); // Handles what to do when the user clicks on a position
+	void handleHover(std::optional<sf::Vector2i> square); // Shows move hints for the player's piece under the mouse
+	bool selectPiece(int file, int rank); // Selects the player's piece on the square and shows its legal destinations, false if there is none
+
+	void playMove(const Move& move); // Plays a legal move for the side to move, from a click or the engine
+	void submitMove(const Move& move); // Plays the move, or online sends it and waits for the server to echo it back
+	bool isRemoteTurn() const; // Online, the other window has the move, or this window is waiting on the server
+	void connectToServer(); // Creates or joins the online game given in the options
+	void pollServer(); // Handles every message the server has sent since the last frame
+	void showArchiveGame(std::size_t game, int ply); // Decodes one archive game and shows it at the given ply
+	void stepReplay(int plies); // Moves through the viewed game, a single step forward only moves the pieces it changes
+	void showReplayPosition(); // Highlights the last move and any check for the replay's current ply
+	void handleViewerKey(sf::Keyboard::Key key);
+	void showMoveResult(const MoveResult& result, bool moverIsWhite); // Prints the move, then highlights and reports check, mate, or draw
+	void takeBack(); // Takes back the last move, and the engine's reply before it when playing the engine
+	void replayMove(); // Plays the most recently taken back move again
+	void showPosition(); // Rebuilds pieces and highlights after a takeback
+	void syncPieces(const Position& position); // Rebuilds the drawn pieces from a position
+	void updatePieces(const Move& move); // Moves the drawn pieces to match a move just made on the position
+	void drawPieces(); // Rebuilds pieceVertices if needed, then draws them
+	bool isEngineTurn() const; // Checks if the engine controls the side given by whiteTurn
+	bool engineShouldStart() const; // Engine has the move and is neither thinking nor waiting on a replay
+	bool playBookMove(); // Plays a weighted random book move for the engine, false if the position is not in the book
+	void showBookMoves(); // Prints the book moves for the player to move
+	bool playTablebaseMove(); // Plays the tablebase's best move for the engine, false if no table covers the position
+	void showTablebaseResult(); // Prints the exact result once a table covers the position
+	void startEngineSearch(); // Asks the engine worker for a move, returns immediately
+	void pollEngine(); // Plays the engine's move once its search has finished
 
-	bool isKingInCheck(bool whiteKing); // Checks if king is in check, takes bool for if the king is white
-	bool isCheckmate(bool whiteKing); // Checks for checkmate
+	void handleEvent(const sf::Event& event); // Handles one window event
+	void renderStaticLayer(); // Draws everything that never changes into staticLayer
+	void render(); // Draws the static layer, highlights, and pieces, then displays the frame
+	void printStats() const;
 
 	void initText(); // Initialize text prototype
 	void initPieces(); // Initialize pieces prototype
@@ -31,6 +122,6 @@ private:
 	bool gameOver = false; // Ends the game if checkmated
 
 public:
-	Game(); // Constructor prototype
+	Game(const GameOptions& gameOptions = GameOptions()); // Constructor prototype
 	void run(); // Main game loop prototype
 };
\ No newline at end of file
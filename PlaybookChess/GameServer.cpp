@@ -0,0 +1,325 @@
+// GameServer.cpp
+// Handles server connections, message routing, and the games on each worker
+
+#include "GameServer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+bool GameServer::Connection::send(const NetMessage& message) {
+	std::lock_guard<std::mutex> lock(sendMutex);
+	if (overflowed) return false;
+	appendFrame(outbox, message);
+	if (flush()) return true; // The usual case, the socket takes the whole frame at once
+
+	if (outbox.size() > maxBacklog) { // The client stopped reading
+		overflowed = true;
+		outbox.clear();
+	}
+	outputPending.store(true);
+	return !overflowed;
+}
+
+bool GameServer::Connection::flush() {
+	if (outbox.empty()) return true;
+	std::size_t sent = 0;
+	sf::Socket::Status status = socket.send(outbox.data(), outbox.size(), sent);
+	if (status == sf::Socket::Status::Disconnected || status == sf::Socket::Status::Error) { // A closed peer is noticed by receive
+		outbox.clear();
+		return true;
+	}
+	outbox.erase(outbox.begin(), outbox.begin() + static_cast<std::ptrdiff_t>(sent));
+	return outbox.empty();
+}
+
+bool GameServer::Connection::track(std::uint32_t id, int limit) {
+	std::lock_guard<std::mutex> lock(gamesMutex);
+	if (std::find(games.begin(), games.end(), id) != games.end()) return true; // Both seats of one game count once
+	if (static_cast<int>(games.size()) >= limit) return false;
+	games.push_back(id);
+	return true;
+}
+
+void GameServer::Connection::forget(std::uint32_t id) {
+	std::lock_guard<std::mutex> lock(gamesMutex);
+	games.erase(std::remove(games.begin(), games.end(), id), games.end());
+}
+
+std::vector<std::uint32_t> GameServer::Connection::openGames() {
+	std::lock_guard<std::mutex> lock(gamesMutex);
+	return games;
+}
+
+// GameServer constructor
+GameServer::GameServer(const ServerOptions& serverOptions) : options(serverOptions) {}
+
+GameServer::~GameServer() {
+	quit.store(true);
+	for (auto& worker : workers) {
+		{
+			std::lock_guard<std::mutex> lock(worker->idleMutex);
+		}
+		worker->idleWake.notify_one();
+		if (worker->thread.joinable()) worker->thread.join();
+	}
+}
+
+bool GameServer::start() {
+	if (listener.listen(options.port) != sf::Socket::Status::Done) return false;
+	selector.add(listener);
+
+	for (int i = 0; i < std::max(1, options.workers); i++) {
+		workers.push_back(std::make_unique<Worker>());
+		workers.back()->thread = std::thread(&GameServer::work, this, std::ref(*workers.back()));
+	}
+	return true;
+}
+
+void GameServer::stop() {
+	quit.store(true); // The network loop notices within one selector timeout
+}
+
+void GameServer::run(std::ostream* log) {
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point lastReport = Clock::now();
+	std::uint64_t reportedMoves = 0, reportedGames = 0;
+
+	while (!quit.load()) {
+		// The selector only reports readable sockets, so waiting output is retried on a short timeout instead
+		if (selector.wait(sf::milliseconds(outputPending.load() ? 1 : 100))) {
+			if (selector.isReady(listener)) acceptConnections();
+			for (std::size_t i = 0; i < connections.size();) {
+				if (selector.isReady(connections[i]->socket) && !receive(connections[i])) closeConnection(i); // The last connection moves into i
+				else i++;
+			}
+			wakeWorkers(); // Once per wakeup, however many messages arrived
+		}
+		if (outputPending.exchange(false)) flushConnections();
+
+		double elapsed = std::chrono::duration<double>(Clock::now() - lastReport).count();
+		if (log && options.reportSeconds > 0 && elapsed >= options.reportSeconds) {
+			std::uint64_t moves = stats.movesPlayed.load(), games = stats.gamesCreated.load();
+			if (moves != reportedMoves || games != reportedGames)
+				*log << "Connections " << stats.connections.load() << ", games " << games << ", moves " << moves
+					<< " (" << static_cast<int>((moves - reportedMoves) / elapsed) << "/s), rejected " << stats.movesRejected.load()
+					<< ", slow disconnects " << stats.slowDisconnects.load() << std::endl;
+			reportedMoves = moves;
+			reportedGames = games;
+			lastReport = Clock::now();
+		}
+	}
+}
+
+void GameServer::acceptConnections() {
+	auto connection = std::make_shared<Connection>(outputPending, options.maxBacklog);
+	if (listener.accept(connection->socket) != sf::Socket::Status::Done) return;
+	if (static_cast<int>(connections.size()) >= options.maxConnections) return; // Dropping the socket closes it, which the client sees at once
+
+	connection->socket.setBlocking(false);
+	selector.add(connection->socket);
+	connections.push_back(std::move(connection));
+	stats.connections++;
+}
+
+bool GameServer::receive(const std::shared_ptr<Connection>& connection) {
+	std::uint8_t data[4096];
+	std::size_t received = 0;
+	sf::Socket::Status status = connection->socket.receive(data, sizeof(data), received);
+	if (status == sf::Socket::Status::NotReady) return true;
+	if (status != sf::Socket::Status::Done) return false;
+
+	connection->reader.append(data, received);
+	while (std::optional<NetMessage> message = connection->reader.next()) {
+		if (static_cast<std::uint8_t>(message->type) >= 0x80) return false; // Server messages are never valid from a client
+		route(*message, connection);
+	}
+	return !connection->reader.failed();
+}
+
+void GameServer::closeConnection(std::size_t index) {
+	std::shared_ptr<Connection> connection = std::move(connections[index]);
+	connections[index] = std::move(connections.back());
+	connections.pop_back();
+	selector.remove(connection->socket);
+	stats.connections--;
+	{
+		std::lock_guard<std::mutex> lock(connection->sendMutex); // Games and queued tasks may keep the connection alive for a while
+		connection->overflowed = true; // Nothing more is sent
+		connection->outbox.clear();
+		connection->socket.disconnect();
+	}
+
+	// Opponents are told by the worker owning each game, which also frees it
+	for (std::uint32_t id : connection->openGames()) {
+		NetMessage leave;
+		leave.type = NetMessageType::Leave;
+		leave.gameId = id;
+		route(leave, connection);
+	}
+}
+
+void GameServer::flushConnections() {
+	bool waiting = false;
+	for (std::size_t i = 0; i < connections.size();) {
+		Connection& connection = *connections[i];
+		bool drop;
+		{
+			std::lock_guard<std::mutex> lock(connection.sendMutex);
+			if (!connection.overflowed && !connection.flush()) waiting = true;
+			drop = connection.overflowed;
+		}
+		if (drop) {
+			stats.slowDisconnects++;
+			closeConnection(i); // The last connection moves into i
+		}
+		else i++;
+	}
+	if (waiting) outputPending.store(true);
+}
+
+void GameServer::route(NetMessage message, const std::shared_ptr<Connection>& from) {
+	if (message.type == NetMessageType::Create) message.gameId = nextGameId++; // Seats are recorded by the worker once it accepts them
+
+	Worker& worker = *workers[message.gameId % workers.size()];
+	Task task{ message, from };
+	while (!worker.tasks.push(task)) { // A worker that far behind is woken and given a moment to catch up
+		worker.needsWake = true;
+		wakeWorkers();
+		std::this_thread::yield();
+	}
+	worker.needsWake = true;
+}
+
+void GameServer::wakeWorkers() {
+	for (auto& worker : workers) {
+		if (!worker->needsWake) continue;
+		worker->needsWake = false;
+		{
+			std::lock_guard<std::mutex> lock(worker->idleMutex); // Orders the push before a worker's check that the queue is empty
+		}
+		worker->idleWake.notify_one();
+	}
+}
+
+void GameServer::work(Worker& worker) {
+	while (!quit.load()) {
+		std::optional<Task> task = worker.tasks.pop();
+		if (!task) {
+			std::unique_lock<std::mutex> lock(worker.idleMutex);
+			worker.idleWake.wait(lock, [this, &worker] { return quit.load() || !worker.tasks.empty(); });
+			continue;
+		}
+		handle(worker, *task);
+	}
+}
+
+static NetMessage reply(NetMessageType type, std::uint32_t gameId, std::uint8_t code = 0) {
+	NetMessage message;
+	message.type = type;
+	message.gameId = gameId;
+	message.code = code;
+	return message;
+}
+
+void GameServer::handle(Worker& worker, Task& task) {
+	const NetMessage& message = task.message;
+	auto found = worker.games.find(message.gameId);
+
+	switch (message.type) {
+	case NetMessageType::Create: {
+		if (!task.from->track(message.gameId, options.maxGamesPerConnection)) {
+			task.from->send(reply(NetMessageType::Rejected, message.gameId, static_cast<std::uint8_t>(NetReject::TooManyGames)));
+			break;
+		}
+		HostedGame& game = worker.games[message.gameId];
+		NetSide side = message.code <= static_cast<std::uint8_t>(NetSide::Both) ? static_cast<NetSide>(message.code) : NetSide::White;
+		if (side == NetSide::Both) {
+			game.players[0] = game.players[1] = task.from;
+			game.started = true;
+		}
+		else {
+			game.players[static_cast<int>(side)] = task.from;
+		}
+		stats.gamesCreated++;
+		task.from->send(reply(NetMessageType::Created, message.gameId, static_cast<std::uint8_t>(side)));
+		if (game.started) task.from->send(reply(NetMessageType::Started, message.gameId));
+		break;
+	}
+	case NetMessageType::Join: {
+		if (found == worker.games.end()) {
+			task.from->send(reply(NetMessageType::Rejected, message.gameId, static_cast<std::uint8_t>(NetReject::NoGame)));
+			break;
+		}
+		HostedGame& game = found->second;
+		int seat = game.players[0] ? 1 : 0;
+		if (game.started || game.players[seat]) {
+			task.from->send(reply(NetMessageType::Rejected, message.gameId, static_cast<std::uint8_t>(NetReject::GameFull)));
+			break;
+		}
+		if (!task.from->track(message.gameId, options.maxGamesPerConnection)) {
+			task.from->send(reply(NetMessageType::Rejected, message.gameId, static_cast<std::uint8_t>(NetReject::TooManyGames)));
+			break;
+		}
+		game.players[seat] = task.from;
+		game.started = true;
+		task.from->send(reply(NetMessageType::Joined, message.gameId, static_cast<std::uint8_t>(seat)));
+		for (auto& player : game.players) player->send(reply(NetMessageType::Started, message.gameId));
+		break;
+	}
+	case NetMessageType::PlayMove:
+		if (found == worker.games.end()) {
+			stats.movesRejected++;
+			task.from->send(reply(NetMessageType::Rejected, message.gameId, static_cast<std::uint8_t>(NetReject::NoGame)));
+		}
+		else {
+			playMove(worker, found->second, task);
+		}
+		break;
+	case NetMessageType::Leave:
+		if (found == worker.games.end()) break;
+		for (int seat = 0; seat < 2; seat++) {
+			if (found->second.players[seat] != task.from) continue;
+			const std::shared_ptr<Connection>& other = found->second.players[1 - seat];
+			if (other && other != task.from) other->send(reply(NetMessageType::Ended, message.gameId));
+			endGame(worker, message.gameId);
+			break;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void GameServer::playMove(Worker& worker, HostedGame& game, Task& task) {
+	std::uint32_t id = task.message.gameId;
+	auto reject = [&](NetReject reason) {
+		stats.movesRejected++;
+		task.from->send(reply(NetMessageType::Rejected, id, static_cast<std::uint8_t>(reason)));
+	};
+	if (!game.started) return reject(NetReject::NotStarted);
+	int seat = game.rules.whiteToMove() ? 0 : 1;
+	if (game.players[seat] != task.from) return reject(NetReject::NotYourTurn);
+
+	// The client's flag bits are not trusted, the rules find the move from its squares
+	Move wanted = task.message.move;
+	std::optional<Move> move = game.rules.findMove(fileOf(wanted.from()), rankOf(wanted.from()), fileOf(wanted.to()), rankOf(wanted.to()));
+	if (!move) return reject(NetReject::IllegalMove);
+	move->setPromotion(wanted.promotion());
+
+	MoveResult result = game.rules.applyMove(*move);
+	stats.movesPlayed++;
+	NetMessage moved = reply(NetMessageType::Moved, id, static_cast<std::uint8_t>(result.result));
+	moved.move = result.move;
+	std::shared_ptr<Connection> players[2] = { game.players[0], game.players[1] }; // Kept alive past the erase below
+	players[seat]->send(moved); // The mover first, it is the acknowledgement they are waiting on
+	if (players[1 - seat] != players[seat]) players[1 - seat]->send(moved);
+	if (result.result != GameResult::Ongoing) endGame(worker, id);
+}
+
+void GameServer::endGame(Worker& worker, std::uint32_t id) {
+	auto found = worker.games.find(id);
+	if (found == worker.games.end()) return;
+	for (auto& player : found->second.players)
+		if (player) player->forget(id);
+	worker.games.erase(found);
+}
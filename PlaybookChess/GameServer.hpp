@@ -0,0 +1,115 @@
+// GameServer.hpp
+// GameServer class
+// Hosts many games at once over TCP: one network thread waits on a socket selector, and a small pool of workers runs the rules
+
+#pragma once
+#include <SFML/Network.hpp>
+#include "NetProtocol.hpp"
+#include "Rules.hpp"
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct ServerOptions {
+	unsigned short port = DefaultServerPort; // 0 picks a free port, see getPort
+	int workers = 2; // Rules threads, each game always runs on the same one
+	int maxConnections = 1000; // The selector is built on select, which cannot watch many more sockets
+	int maxGamesPerConnection = 16; // Open games one client may hold, further Creates and Joins are rejected
+	int reportSeconds = 10; // Status line interval while anything changes, 0 for none
+	std::size_t maxBacklog = 256 * 1024; // Unsent bytes a client may fall behind by before it is disconnected
+};
+
+struct ServerStats {
+	std::atomic<int> connections{ 0 };
+	std::atomic<std::uint64_t> gamesCreated{ 0 };
+	std::atomic<std::uint64_t> movesPlayed{ 0 };
+	std::atomic<std::uint64_t> movesRejected{ 0 };
+	std::atomic<std::uint64_t> slowDisconnects{ 0 }; // Clients dropped for not reading their replies
+};
+
+// The network thread only reads and routes, workers answer on the sockets directly. A game's id picks its
+// worker, so one thread owns each game's Rules and no game needs a lock.
+// Sockets never block: a reply the socket cannot take yet waits in the connection's outbox, and the network
+// thread writes it out later, so a client that stops reading cannot stall a worker and every game on it.
+class GameServer {
+private:
+	struct Connection {
+		sf::TcpSocket socket; // Non-blocking
+		FrameReader reader; // Network thread only
+		std::mutex sendMutex; // Both players of a game can be answered from different workers
+		std::vector<std::uint8_t> outbox; // Guarded by sendMutex, frames the socket has not taken yet
+		bool overflowed = false; // Guarded by sendMutex, set once the outbox passed the limit or the connection closed, nothing more is sent
+		std::mutex gamesMutex; // Workers add and remove seats, the network thread reads them when the socket closes
+		std::vector<std::uint32_t> games; // Guarded by gamesMutex, games with a seat for this connection, left when it closes
+		std::atomic<bool>& outputPending; // The server's flag, set while any outbox is waiting on the network thread
+		std::size_t maxBacklog;
+
+		Connection(std::atomic<bool>& pending, std::size_t limit) : outputPending(pending), maxBacklog(limit) {} // Constructor
+		bool send(const NetMessage& message); // Queues the frame and writes what the socket takes now, false once overflowed
+		bool flush(); // Writes queued bytes with sendMutex held, true once the outbox is empty
+		bool track(std::uint32_t id, int limit); // Records a seat once the worker accepted it, false if limit games are already open
+		void forget(std::uint32_t id);
+		std::vector<std::uint32_t> openGames();
+	};
+
+	struct Task {
+		NetMessage message;
+		std::shared_ptr<Connection> from;
+	};
+
+	struct HostedGame {
+		Rules rules;
+		std::shared_ptr<Connection> players[2]; // White and black seats, the same connection twice for NetSide::Both
+		bool started = false;
+	};
+
+	struct Worker {
+		SpscQueue<Task, 4096> tasks; // Network thread pushes, the worker pops
+		std::unordered_map<std::uint32_t, HostedGame> games; // Worker thread only
+		std::mutex idleMutex; // Only used to sleep while there is nothing to do
+		std::condition_variable idleWake;
+		bool needsWake = false; // Network thread only, tasks were pushed since the last wake
+		std::thread thread;
+	};
+
+	ServerOptions options;
+	ServerStats stats;
+	sf::TcpListener listener;
+	sf::SocketSelector selector;
+	std::vector<std::shared_ptr<Connection>> connections;
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::uint32_t nextGameId = 1; // Network thread only
+	std::atomic<bool> quit{ false };
+	std::atomic<bool> outputPending{ false };
+
+	void acceptConnections();
+	bool receive(const std::shared_ptr<Connection>& connection); // Reads and routes whatever arrived, false if the connection should close
+	void closeConnection(std::size_t index);
+	void flushConnections(); // Retries every waiting outbox and drops clients that overflowed
+	void route(NetMessage message, const std::shared_ptr<Connection>& from);
+	void wakeWorkers();
+
+	void work(Worker& worker); // Body of a worker thread
+	void handle(Worker& worker, Task& task);
+	void playMove(Worker& worker, HostedGame& game, Task& task);
+	static void endGame(Worker& worker, std::uint32_t id); // Frees the game and both players' seats
+
+public:
+	explicit GameServer(const ServerOptions& serverOptions = ServerOptions()); // Constructor
+	~GameServer(); // Stops the workers
+	GameServer(const GameServer&) = delete;
+	GameServer& operator=(const GameServer&) = delete;
+
+	bool start(); // Listens and starts the workers, false if the port cannot be opened
+	void run(std::ostream* log = nullptr); // Network loop, returns after stop
+	void stop(); // Safe from any thread
+	unsigned short getPort() const { return listener.getLocalPort(); }
+	const ServerStats& getStats() const { return stats; }
+};
@@ -0,0 +1,222 @@
+// LoadGenMain.cpp
+// Load generator for the game server, plays random legal games over loopback and measures the round trip of every move
+// Usage: loadgen [--host h] [--port n] [--games n] [--rounds n] [--plies n] [--local workers] [--seed n]
+// --games connection pairs play at once, each plays --rounds games of at most --plies moves.
+// --local starts a server in this process on a free port instead of connecting to --host.
+// Every socket goes through one select-based selector, so keep games below about 200 with --local and 450 without.
+
+#include "GameServer.hpp"
+#include "MoveGen.hpp"
+#include "NetClient.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Two connections sharing one game, white creates it and black joins
+struct LoadGame {
+	NetClient seats[2];
+	Rules rules;
+	std::mt19937_64 rng;
+	std::uint32_t gameId = 0;
+	int roundsLeft = 0;
+	int plies = 0;
+	int mover = -1; // Seat whose move is waiting on its acknowledgement, -1 if none
+	Move sent; // That move, so the opponent's copy of the previous move is not taken for its acknowledgement
+	Clock::time_point sentAt;
+};
+
+struct LoadTotals {
+	std::uint64_t moves = 0;
+	std::uint64_t games = 0;
+	std::uint64_t rejected = 0;
+	std::vector<double> latencyUs; // Send to acknowledgement, one per move
+};
+
+static void startRound(LoadGame& game) {
+	game.rules.reset();
+	game.plies = 0;
+	game.gameId = 0;
+	game.mover = -1;
+	NetMessage create;
+	create.type = NetMessageType::Create;
+	create.code = static_cast<std::uint8_t>(NetSide::White);
+	game.seats[0].send(create);
+}
+
+static void sendRandomMove(LoadGame& game) {
+	Position position = game.rules.getPosition();
+	MoveList moves;
+	generateLegalMoves(position, moves);
+	NetMessage play;
+	play.type = NetMessageType::PlayMove;
+	play.gameId = game.gameId;
+	play.move = moves[static_cast<int>(game.rng() % moves.size())];
+	game.sent = play.move;
+	game.mover = game.rules.whiteToMove() ? 0 : 1;
+	game.sentAt = Clock::now();
+	game.seats[game.mover].send(play);
+}
+
+// Leaves the game unless it already ended on the board, then starts the next round. Returns false once all rounds are done.
+static bool finishRound(LoadGame& game, LoadTotals& totals) {
+	totals.games++;
+	if (!game.rules.isGameOver()) {
+		NetMessage leave;
+		leave.type = NetMessageType::Leave;
+		leave.gameId = game.gameId;
+		game.seats[0].send(leave);
+	}
+	if (--game.roundsLeft == 0) return false;
+	startRound(game);
+	return true;
+}
+
+// Returns false once the game has played all its rounds
+static bool handleMessage(LoadGame& game, int seat, const NetMessage& message, int maxPlies, LoadTotals& totals) {
+	switch (message.type) {
+	case NetMessageType::Created: {
+		game.gameId = message.gameId;
+		NetMessage join;
+		join.type = NetMessageType::Join;
+		join.gameId = message.gameId;
+		game.seats[1].send(join);
+		break;
+	}
+	case NetMessageType::Started:
+		if (seat == 0 && message.gameId == game.gameId) sendRandomMove(game);
+		break;
+	case NetMessageType::Moved:
+		if (seat != game.mover || message.gameId != game.gameId || message.move != game.sent) break; // The opponent's copy, or a leftover from the last round
+		totals.latencyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - game.sentAt).count());
+		totals.moves++;
+		game.mover = -1;
+		game.rules.applyMove(message.move);
+		if (game.rules.isGameOver() || ++game.plies >= maxPlies) return finishRound(game, totals);
+		sendRandomMove(game);
+		break;
+	case NetMessageType::Rejected:
+		std::cerr << "ERROR: Game " << message.gameId << " rejected a message: " << rejectReason(static_cast<NetReject>(message.code)) << std::endl;
+		totals.rejected++;
+		if (message.gameId == game.gameId) return finishRound(game, totals);
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+static double percentile(std::vector<double>& values, double fraction) {
+	if (values.empty()) return 0.0;
+	std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(fraction * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+int main(int argc, char* argv[]) {
+	std::string host = "127.0.0.1";
+	unsigned short port = DefaultServerPort;
+	int gameCount = 50, rounds = 4, maxPlies = 200, localWorkers = 0;
+	std::uint64_t seed = 1;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--host") host = argv[i + 1];
+		else if (arg == "--port") port = static_cast<unsigned short>(std::atoi(argv[i + 1]));
+		else if (arg == "--games") gameCount = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--rounds") rounds = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--plies") maxPlies = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--local") localWorkers = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--seed") seed = std::strtoull(argv[i + 1], nullptr, 10);
+	}
+
+	std::unique_ptr<GameServer> server;
+	std::thread serverThread;
+	if (localWorkers > 0) {
+		ServerOptions serverOptions;
+		serverOptions.port = 0;
+		serverOptions.workers = localWorkers;
+		serverOptions.reportSeconds = 0;
+		server = std::make_unique<GameServer>(serverOptions);
+		if (!server->start()) {
+			std::cerr << "ERROR: Could not start the local server" << std::endl;
+			return 1;
+		}
+		host = "127.0.0.1";
+		port = server->getPort();
+		serverThread = std::thread([&server] { server->run(); });
+	}
+
+	std::vector<std::unique_ptr<LoadGame>> games;
+	sf::SocketSelector selector;
+	for (int i = 0; i < gameCount; i++) {
+		auto game = std::make_unique<LoadGame>();
+		game->rng.seed(seed + i);
+		game->roundsLeft = rounds;
+		for (NetClient& client : game->seats) {
+			if (!client.connect(host, port)) {
+				std::cerr << "ERROR: Could not connect to " << host << ":" << port << std::endl;
+				if (server) {
+					server->stop();
+					serverThread.join();
+				}
+				return 1;
+			}
+			selector.add(client.getSocket());
+		}
+		games.push_back(std::move(game));
+	}
+
+	LoadTotals totals;
+	totals.latencyUs.reserve(static_cast<std::size_t>(gameCount) * rounds * maxPlies);
+	Clock::time_point start = Clock::now();
+	for (auto& game : games) startRound(*game);
+
+	int active = gameCount;
+	bool failed = false;
+	while (active > 0 && !failed) {
+		if (!selector.wait(sf::seconds(5))) {
+			std::cerr << "ERROR: No reply from the server in 5 seconds" << std::endl;
+			failed = true;
+			break;
+		}
+		for (auto& game : games) {
+			if (game->roundsLeft == 0) continue;
+			for (int seat = 0; seat < 2 && game->roundsLeft > 0; seat++) {
+				NetClient& client = game->seats[seat];
+				if (!selector.isReady(client.getSocket())) continue;
+				while (std::optional<NetMessage> message = client.poll()) {
+					if (!handleMessage(*game, seat, *message, maxPlies, totals)) {
+						game->roundsLeft = 0;
+						active--;
+						break;
+					}
+				}
+				if (!client.isConnected() && game->roundsLeft > 0) {
+					std::cerr << "ERROR: The server closed a connection" << std::endl;
+					failed = true;
+				}
+			}
+		}
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	if (server) {
+		server->stop();
+		serverThread.join();
+	}
+
+	std::cout << "Games: " << totals.games << " (" << gameCount << " at once, " << 2 * gameCount << " connections)\n";
+	std::cout << "Moves: " << totals.moves << " in " << seconds << " s, " << static_cast<std::uint64_t>(totals.moves / seconds) << " moves/s\n";
+	std::cout << "Round trip: p50 " << percentile(totals.latencyUs, 0.50) << " us, p99 " << percentile(totals.latencyUs, 0.99)
+		<< " us, max " << percentile(totals.latencyUs, 1.0) << " us\n";
+	std::cout << "Rejected: " << totals.rejected << std::endl;
+	return failed || totals.rejected > 0 ? 1 : 0;
+}
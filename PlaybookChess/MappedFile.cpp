@@ -0,0 +1,79 @@
+// MappedFile.cpp
+// Platform memory mapping
+// MappedFile class functions
+
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+	close();
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) { close(); return false; }
+	length = static_cast<std::size_t>(fileSize.QuadPart);
+	if (length == 0) return true; // Empty files cannot be mapped, but are valid input
+
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) { close(); return false; }
+	bytes = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!bytes) { close(); return false; }
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle) CloseHandle(fileHandle);
+	bytes = nullptr;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	length = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+	close();
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) { close(); return false; }
+	length = static_cast<std::size_t>(info.st_size);
+	if (length == 0) return true; // Empty files cannot be mapped, but are valid input
+
+	void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapped == MAP_FAILED) { close(); return false; }
+	madvise(mapped, length, MADV_SEQUENTIAL); // Each thread reads its chunk front to back
+	bytes = static_cast<const char*>(mapped);
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) munmap(const_cast<char*>(bytes), length);
+	if (fd != -1) ::close(fd);
+	bytes = nullptr;
+	fd = -1;
+	length = 0;
+}
+
+#endif
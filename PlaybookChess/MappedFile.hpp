@@ -0,0 +1,33 @@
+// MappedFile.hpp
+// MappedFile class
+// Read-only memory map of a whole file, so large inputs are parsed in place without copying
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+private:
+	const char* bytes = nullptr;
+	std::size_t length = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fd = -1;
+#endif
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path); // Returns false if the file could not be opened or mapped
+	void close();
+
+	const char* data() const { return bytes; }
+	std::size_t size() const { return length; }
+	std::string_view view() const { return std::string_view(bytes, length); }
+};
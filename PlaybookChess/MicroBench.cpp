@@ -0,0 +1,104 @@
+// MicroBench.cpp
+// Handles microbenchmark reporting
+
+#include "MicroBench.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// MicroBench constructor
+MicroBench::MicroBench(double minimumSeconds, const std::string& nameFilter) : minSeconds(minimumSeconds), filter(nameFilter) {}
+
+void MicroBench::skip(const std::string& name, const std::string& reason) {
+	if (selected(name)) std::cerr << "Skipped " << name << ": " << reason << std::endl;
+}
+
+void MicroBench::printTable(std::ostream& out) const {
+	out << std::left << std::setw(32) << "Benchmark" << std::right << std::setw(14) << "ns/op" << std::setw(14) << "CPU ns/op"
+		<< std::setw(16) << "Iterations" << "\n";
+	for (const MicroResult& r : results)
+		out << std::left << std::setw(32) << r.name << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(14) << r.nsPerOp << std::setw(14) << r.cpuNsPerOp << std::setw(16) << r.iterations << "\n";
+	out << std::defaultfloat;
+	out.flush();
+}
+
+static std::string escapeJson(const std::string& s) {
+	std::string escaped;
+	for (char c : s) {
+		if (c == '"' || c == '\\') escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+void MicroBench::writeJson(std::ostream& out) const {
+	std::time_t now = std::time(nullptr);
+	char date[32];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	out << "{\n  \"context\": {\n";
+	out << "    \"date\": \"" << date << "\",\n";
+	out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+	out << "    \"library_build_type\": \"release\",\n";
+#else
+	out << "    \"library_build_type\": \"debug\",\n";
+#endif
+	out << "    \"min_time\": " << minSeconds << "\n  },\n";
+
+	// One benchmark per line, which keeps text diffs readable and lets readJson parse line by line
+	out << "  \"benchmarks\": [\n";
+	for (std::size_t i = 0; i < results.size(); i++) {
+		const MicroResult& r = results[i];
+		out << "    {\"name\": \"" << escapeJson(r.name) << "\", \"run_type\": \"iteration\", \"iterations\": " << r.iterations
+			<< ", \"real_time\": " << std::setprecision(6) << r.nsPerOp << ", \"cpu_time\": " << r.cpuNsPerOp
+			<< ", \"time_unit\": \"ns\", \"checksum\": " << r.checksum << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}" << std::endl;
+}
+
+// Value after "key": on the line, empty if missing
+static std::string jsonField(const std::string& line, const std::string& key) {
+	std::size_t at = line.find("\"" + key + "\":");
+	if (at == std::string::npos) return "";
+	std::size_t begin = line.find_first_not_of(" \"", at + key.size() + 3);
+	std::size_t end = line.find_first_of(",}\"", begin);
+	return begin == std::string::npos ? "" : line.substr(begin, end - begin);
+}
+
+bool MicroBench::readJson(const std::string& path, std::vector<MicroResult>& out) {
+	std::ifstream in(path);
+	if (!in) return false;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::string name = jsonField(line, "name");
+		if (name.empty()) continue;
+		MicroResult r;
+		r.name = name;
+		r.iterations = std::strtoull(jsonField(line, "iterations").c_str(), nullptr, 10);
+		r.nsPerOp = std::atof(jsonField(line, "real_time").c_str());
+		r.cpuNsPerOp = std::atof(jsonField(line, "cpu_time").c_str());
+		r.checksum = std::strtoull(jsonField(line, "checksum").c_str(), nullptr, 10);
+		out.push_back(r);
+	}
+	return true;
+}
+
+void MicroBench::printComparison(std::ostream& out, const std::vector<MicroResult>& baseline) const {
+	out << std::left << std::setw(32) << "Benchmark" << std::right << std::setw(14) << "Base ns/op" << std::setw(14) << "ns/op"
+		<< std::setw(10) << "Change" << "\n";
+	for (const MicroResult& r : results) {
+		for (const MicroResult& b : baseline) {
+			if (b.name != r.name) continue;
+			double change = b.nsPerOp > 0 ? (r.nsPerOp - b.nsPerOp) / b.nsPerOp * 100.0 : 0.0;
+			out << std::left << std::setw(32) << r.name << std::right << std::fixed << std::setprecision(2)
+				<< std::setw(14) << b.nsPerOp << std::setw(14) << r.nsPerOp << std::setw(9) << std::showpos << change << "%" << std::noshowpos
+				<< (b.checksum != r.checksum ? "  (checksum differs)" : "") << "\n";
+		}
+	}
+	out << std::defaultfloat;
+	out.flush();
+}
@@ -0,0 +1,64 @@
+// MicroBench.hpp
+// MicroBench class
+// Timing harness for small hot functions, with JSON output that can be diffed between builds
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct MicroResult {
+	std::string name;
+	std::uint64_t iterations = 0; // Operations timed, summed over every batch
+	double nsPerOp = 0.0; // Wall time
+	double cpuNsPerOp = 0.0; // Process CPU time
+	std::uint64_t checksum = 0; // Value one call returns, a build that computes something different shows up here
+};
+
+class MicroBench {
+private:
+	double minSeconds;
+	std::string filter; // Only names containing this run, all if empty
+	std::vector<MicroResult> results;
+	volatile std::uint64_t sink = 0;
+
+public:
+	explicit MicroBench(double minimumSeconds = 0.25, const std::string& nameFilter = ""); // Constructor
+	bool selected(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+	const std::vector<MicroResult>& getResults() const { return results; }
+
+	// Calls body in doubling batches until minSeconds have passed. Each call performs opsPerCall operations
+	// and returns the same value every time, which becomes the checksum.
+	template <typename Body>
+	void run(const std::string& name, Body&& body, std::uint64_t opsPerCall = 1) {
+		if (!selected(name) || opsPerCall == 0) return;
+		MicroResult r;
+		r.name = name;
+		r.checksum = body(); // Also warms the caches and branch predictors before timing
+
+		double wall = 0.0, cpu = 0.0;
+		std::uint64_t calls = 0, sum = 0;
+		for (std::uint64_t batch = 1; wall < minSeconds; batch *= 2) {
+			std::clock_t cpuStart = std::clock();
+			auto start = std::chrono::steady_clock::now();
+			for (std::uint64_t i = 0; i < batch; i++) sum += body();
+			wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			cpu += static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+			calls += batch;
+		}
+		sink = sum; // Results are used, so the calls cannot be optimized away
+		r.iterations = calls * opsPerCall;
+		r.nsPerOp = wall * 1e9 / r.iterations;
+		r.cpuNsPerOp = cpu * 1e9 / r.iterations;
+		results.push_back(r);
+	}
+
+	void skip(const std::string& name, const std::string& reason); // Reports a benchmark that could not run here
+	void printTable(std::ostream& out) const;
+	void writeJson(std::ostream& out) const; // Same layout as Google Benchmark's --benchmark_format=json, so its compare tools work
+	static bool readJson(const std::string& path, std::vector<MicroResult>& out); // Reads files written by writeJson
+	void printComparison(std::ostream& out, const std::vector<MicroResult>& baseline) const;
+};
@@ -0,0 +1,221 @@
+// MicroBenchMain.cpp
+// Microbenchmarks for the rules and rendering hot paths
+// Usage: microbench [--json file] [--compare base.json] [--filter text] [--min-time seconds]
+// The rules cases time the functions Piece and Rules delegate to. The frame case needs SFML and is skipped without it.
+
+#include "MicroBench.hpp"
+#include "MoveGen.hpp"
+#include "Position.hpp"
+#include "Rules.hpp"
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef PLAYBOOKCHESS_MICROBENCH_DRAW
+#include "Board.hpp"
+#include "PieceTable.hpp"
+#include "Rendering.hpp"
+#endif
+
+// Fixed middlegame and endgame positions, including checks and checkmates so both outcomes are timed
+static const std::vector<std::string> MicroPositions = {
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"r2q1rk1/pp2bppp/2n1pn2/3p4/3P4/2NBPN2/PP3PPP/R2Q1RK1 w - - 0 10",
+	"2r3k1/pp3pp1/4p2p/3n4/3P4/P4N1P/1P3PP1/2R3K1 w - - 0 25",
+	"8/5pk1/6p1/7p/7P/6P1/5PK1/3R4 w - - 0 40",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	"rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3", // Checkmated
+	"r1bqkbnr/pppp1Qpp/2n5/4p3/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4", // Checkmated
+	"rnbqkbnr/ppp2ppp/8/1B1pp3/4P3/8/PPPP1PPP/RNBQK1NR b KQkq - 1 3", // In check
+	"6k1/5ppp/8/8/8/8/5PPP/3r2K1 w - - 0 30", // Back rank mate
+};
+
+struct MoveQuery {
+	int position;
+	int from, to;
+};
+
+static void addRulesBenchmarks(MicroBench& bench) {
+	std::vector<Position> positions(MicroPositions.size());
+	for (std::size_t i = 0; i < MicroPositions.size(); i++) positions[i].setFromFen(MicroPositions[i]);
+
+	// Every destination for every piece of the type, for both colors
+	const char* names[6] = { "Pawn", "Knight", "Bishop", "Rook", "Queen", "King" };
+	for (int t = 0; t < 6; t++) {
+		std::vector<MoveQuery> queries;
+		for (int p = 0; p < static_cast<int>(positions.size()); p++) {
+			for (Color c : { White, Black }) {
+				for (Bitboard b = positions[p].pieces(c, static_cast<PieceType>(t)); b; ) {
+					int from = popLsb(b);
+					for (int to = 0; to < 64; to++) queries.push_back({ p, from, to });
+				}
+			}
+		}
+		bench.run(std::string("isValidMove/") + names[t], [&] {
+			std::uint64_t valid = 0;
+			for (const MoveQuery& q : queries) valid += positions[q.position].isValidMove(q.from, q.to);
+			return valid;
+		}, queries.size());
+	}
+
+	// Every pair of squares on a shared rank, file, or diagonal
+	std::vector<MoveQuery> lines;
+	for (int p = 0; p < static_cast<int>(positions.size()); p++)
+		for (int from = 0; from < 64; from++)
+			for (int to = 0; to < 64; to++)
+				if (from != to && lineBB(from, to)) lines.push_back({ p, from, to });
+	bench.run("isPathClear", [&] {
+		std::uint64_t clear = 0;
+		for (const MoveQuery& q : lines) clear += positions[q.position].isPathClear(q.from, q.to);
+		return clear;
+	}, lines.size());
+
+	// Whole move lists, the side to move in each position
+	bench.run("generatePseudoLegalMoves", [&] {
+		std::uint64_t count = 0;
+		MoveList moves;
+		for (const Position& position : positions) {
+			generatePseudoLegalMoves(position, moves);
+			count += moves.count;
+		}
+		return count;
+	}, positions.size());
+	bench.run("generateLegalMoves", [&] {
+		std::uint64_t count = 0;
+		MoveList moves;
+		for (Position& position : positions) {
+			generateLegalMoves(position, moves);
+			count += moves.count;
+		}
+		return count;
+	}, positions.size());
+	bench.run("generateLegalCaptures", [&] {
+		std::uint64_t count = 0;
+		MoveList moves;
+		for (Position& position : positions) {
+			generateLegalCaptures(position, moves);
+			count += moves.count;
+		}
+		return count;
+	}, positions.size());
+
+	std::vector<Rules> games(MicroPositions.size());
+	for (std::size_t i = 0; i < MicroPositions.size(); i++) games[i].reset(MicroPositions[i]);
+	bench.run("isKingInCheck", [&] {
+		std::uint64_t checks = 0;
+		for (const Rules& g : games) checks += g.isKingInCheck(true) + g.isKingInCheck(false);
+		return checks;
+	}, 2 * games.size());
+
+	// Rules answers isCheckmate from moves generated once per position, so time that generation instead of the cached read
+	bench.run("mateDetection", [&] {
+		std::uint64_t mates = 0;
+		MoveList moves;
+		for (Position& position : positions) {
+			generateLegalMoves(position, moves);
+			mates += moves.empty() && position.isInCheck(position.sideToMove());
+		}
+		return mates;
+	}, positions.size());
+
+	// A move and its takeback, each regenerating the legal moves and destination cache through updateResult
+	std::vector<std::pair<Rules*, Move>> plays;
+	for (std::size_t i = 0; i < games.size(); i++) {
+		MoveList moves;
+		generateLegalMoves(positions[i], moves);
+		if (!moves.empty()) plays.push_back({ &games[i], moves.moves[0] });
+	}
+	bench.run("applyMove+undoMove", [&] {
+		std::uint64_t results = 0;
+		for (auto& [game, move] : plays) {
+			results += static_cast<std::uint64_t>(game->applyMove(move).result);
+			game->undoMove();
+		}
+		return results;
+	}, plays.size());
+}
+
+#ifdef PLAYBOOKCHESS_MICROBENCH_DRAW
+// One frame as the game draws it after a move: board, highlights, and a rebuilt piece batch, offscreen
+static void addDrawBenchmarks(MicroBench& bench) {
+	sf::Image atlas;
+	sf::RenderTexture target;
+	if (!loadPieceAtlasImage(atlas) || !loadPieceTextures(atlas)) {
+		bench.skip("drawFrame", "piece sprites not found");
+		return;
+	}
+	if (!target.resize({ 1024, 1024 })) {
+		bench.skip("drawFrame", "no offscreen render target, a graphics context is needed");
+		return;
+	}
+
+	Board board;
+	board.initialize();
+	PieceTable pieces;
+	Position position;
+	position.setFromFen(MicroPositions[0]);
+	for (int sq = 0; sq < 64; sq++)
+		if (position.pieceOn(sq) != NoPiece)
+			pieces.add(fileOf(sq), rankOf(sq), colorOf(position.pieceOn(sq)) == White, typeOf(position.pieceOn(sq)));
+
+	sf::VertexArray pieceVertices(sf::PrimitiveType::Triangles);
+	int frame = 0;
+	bench.run("drawFrame", [&] {
+		board.setMoveSquare(1 + frame % 8, 1 + frame / 8 % 8); // Highlights change like they do after a move
+		frame++;
+		target.clear(sf::Color(50, 50, 50));
+		board.drawSquares(target);
+		board.draw(target);
+		pieceVertices.clear();
+		pieces.appendVertices(pieceVertices);
+		target.draw(pieceVertices, &pieceAtlas);
+		target.display();
+		return static_cast<std::uint64_t>(pieceVertices.getVertexCount());
+	});
+}
+#endif
+
+int main(int argc, char* argv[]) {
+	std::string jsonPath, comparePath, filter;
+	double minSeconds = 0.25;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--json") jsonPath = argv[i + 1];
+		else if (arg == "--compare") comparePath = argv[i + 1];
+		else if (arg == "--filter") filter = argv[i + 1];
+		else if (arg == "--min-time") minSeconds = std::atof(argv[i + 1]);
+	}
+
+	MicroBench bench(minSeconds, filter);
+	addRulesBenchmarks(bench);
+#ifdef PLAYBOOKCHESS_MICROBENCH_DRAW
+	addDrawBenchmarks(bench);
+#else
+	bench.skip("drawFrame", "built without SFML");
+#endif
+	bench.printTable(std::cout);
+
+	if (!jsonPath.empty()) {
+		std::ofstream out(jsonPath);
+		bench.writeJson(out);
+		if (!out) {
+			std::cerr << "ERROR: Could not write " << jsonPath << std::endl;
+			return 1;
+		}
+	}
+	if (!comparePath.empty()) {
+		std::vector<MicroResult> baseline;
+		if (!MicroBench::readJson(comparePath, baseline)) {
+			std::cerr << "ERROR: Could not read " << comparePath << std::endl;
+			return 1;
+		}
+		std::cout << "\n";
+		bench.printComparison(std::cout, baseline);
+	}
+	return 0;
+}
@@ -0,0 +1,59 @@
+// Move.hpp
+// Move class
+// Fixed-capacity move list
+
+#pragma once
+#include "Types.hpp"
+#include <cstdint>
+
+enum class MoveFlag : std::uint8_t {
+	Normal, Promotion, EnPassant, Castling
+};
+
+// Packed into 16 bits, low to high: from 6, to 6, flag 2, promotion 2 (knight to queen).
+// Non-promotions keep the promotion bits clear, so equal moves always have equal bits.
+class Move {
+private:
+	std::uint16_t bits = 0;
+
+public:
+	Move() = default;
+	Move(int from, int to, MoveFlag flag = MoveFlag::Normal, PieceType promotion = PieceType::Queen)
+		: bits(static_cast<std::uint16_t>(from | (to << 6) | (static_cast<int>(flag) << 12)
+			| (flag == MoveFlag::Promotion ? (static_cast<int>(promotion) - 1) << 14 : 0))) {}
+
+	int from() const { return bits & 63; }
+	int to() const { return (bits >> 6) & 63; }
+	MoveFlag flag() const { return static_cast<MoveFlag>((bits >> 12) & 3); }
+	PieceType promotion() const { return flag() == MoveFlag::Promotion ? static_cast<PieceType>((bits >> 14) + 1) : PieceType::Queen; }
+	void setPromotion(PieceType type) { if (flag() == MoveFlag::Promotion) bits = static_cast<std::uint16_t>((bits & 0x3FFF) | ((static_cast<int>(type) - 1) << 14)); }
+
+	std::uint16_t raw() const { return bits; }
+	static Move fromRaw(std::uint16_t raw) {
+		Move m;
+		m.bits = raw;
+		return m;
+	}
+
+	bool operator==(const Move& other) const { return bits == other.bits; }
+	bool operator!=(const Move& other) const { return bits != other.bits; }
+};
+static_assert(sizeof(Move) == 2, "Move must stay packed");
+
+// Move list stored inline, no position has more than 218 legal moves
+struct MoveList {
+	Move moves[256];
+	int count = 0;
+
+	void add(int from, int to, MoveFlag flag = MoveFlag::Normal, PieceType promotion = PieceType::Queen) {
+		moves[count++] = Move(from, to, flag, promotion);
+	}
+	int size() const { return count; }
+	bool empty() const { return count == 0; }
+	Move& operator[](int i) { return moves[i]; }
+	const Move& operator[](int i) const { return moves[i]; }
+	Move* begin() { return moves; }
+	Move* end() { return moves + count; }
+	const Move* begin() const { return moves; }
+	const Move* end() const { return moves + count; }
+};
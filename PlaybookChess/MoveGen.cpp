@@ -0,0 +1,163 @@
+// MoveGen.cpp
+// Generates moves from the position's bitboards
+
+#include "MoveGen.hpp"
+
+// Adds a move to every square in targets
+static void addMoves(MoveList& moves, int from, Bitboard targets) {
+	while (targets)
+		moves.add(from, popLsb(targets));
+}
+
+// Adds a pawn move to every square in targets, each from the square Delta behind it
+template<int Delta>
+static void addPawnTargets(MoveList& moves, Bitboard targets) {
+	while (targets) {
+		int to = popLsb(targets);
+		moves.add(to - Delta, to);
+	}
+}
+
+template<int Delta, bool CapturesOnly>
+static void addPromotions(MoveList& moves, Bitboard targets) {
+	while (targets) {
+		int to = popLsb(targets);
+		moves.add(to - Delta, to, MoveFlag::Promotion, PieceType::Queen);
+		if constexpr (!CapturesOnly) { // Underpromotions are left to the full generator
+			for (PieceType promo : { PieceType::Rook, PieceType::Bishop, PieceType::Knight })
+				moves.add(to - Delta, to, MoveFlag::Promotion, promo);
+		}
+	}
+}
+
+// Every pawn at once, by shifting the pawn bitboard in each direction the color moves
+template<Color Us, bool CapturesOnly>
+static void addPawnMoves(const Position& position, MoveList& moves) {
+	constexpr Color Them = ~Us;
+	constexpr int Up = pawnPush(Us);
+	constexpr int UpWest = Up - 1, UpEast = Up + 1; // Captures toward the a-file and the h-file
+	constexpr Bitboard DoublePushRank = rankBB(relativeRank(Us, 3)); // A single push landing here may step again
+	constexpr Bitboard PromotionRank = rankBB(relativeRank(Us, 8));
+
+	Bitboard pawns = position.pieces(Us, PieceType::Pawn);
+	Bitboard enemies = position.pieces(Them);
+	Bitboard empty = ~position.occupied();
+
+	Bitboard single = shiftBB<Up>(pawns) & empty;
+	Bitboard west = shiftBB<UpWest>(pawns & ~FileABB) & enemies;
+	Bitboard east = shiftBB<UpEast>(pawns & ~FileHBB) & enemies;
+
+	if constexpr (!CapturesOnly) {
+		addPawnTargets<Up>(moves, single & ~PromotionRank);
+		addPawnTargets<2 * Up>(moves, shiftBB<Up>(single & DoublePushRank) & empty);
+	}
+	addPawnTargets<UpWest>(moves, west & ~PromotionRank);
+	addPawnTargets<UpEast>(moves, east & ~PromotionRank);
+
+	// Promotions count as tactical moves, pushes included
+	addPromotions<Up, CapturesOnly>(moves, single & PromotionRank);
+	addPromotions<UpWest, CapturesOnly>(moves, west & PromotionRank);
+	addPromotions<UpEast, CapturesOnly>(moves, east & PromotionRank);
+
+	int ep = position.enPassantSquare();
+	if (ep != -1) {
+		Bitboard capturers = pawnAttacks<Them>(ep) & pawns; // Our pawns that attack the square, seen from it
+		while (capturers)
+			moves.add(popLsb(capturers), ep, MoveFlag::EnPassant);
+	}
+}
+
+// Knights, sliders, and the king, one attack lookup per piece with the type fixed at compile time
+template<Color Us, PieceType Pt>
+static void addPieceMoves(const Position& position, MoveList& moves, Bitboard targets) {
+	Bitboard occ = position.occupied();
+	Bitboard pieces = position.pieces(Us, Pt);
+	while (pieces) {
+		int from = popLsb(pieces);
+		addMoves(moves, from, attacks<Pt>(from, occ) & targets);
+	}
+}
+
+template<Color Us>
+static void addCastlingMoves(const Position& position, MoveList& moves) {
+	constexpr Color Them = ~Us;
+	constexpr int Rank = relativeRank(Us, 1);
+	constexpr int KingSide = Us == White ? WhiteKingSide : BlackKingSide;
+	constexpr int QueenSide = Us == White ? WhiteQueenSide : BlackQueenSide;
+	constexpr int KingFrom = square(5, Rank);
+
+	if (!(position.castlingRights() & (KingSide | QueenSide)) || position.kingSquare(Us) != KingFrom
+		|| position.isAttackedBy<Them>(KingFrom))
+		return;
+
+	// The rook must still be in its corner, the squares between king and rook must be empty,
+	// and the king may not pass through an attacked square
+	Bitboard rooks = position.pieces(Us, PieceType::Rook);
+	if ((position.castlingRights() & KingSide) && (rooks & squareBB(square(8, Rank))) && position.isPathClear(KingFrom, square(8, Rank))
+		&& !position.isAttackedBy<Them>(square(6, Rank)) && !position.isAttackedBy<Them>(square(7, Rank)))
+		moves.add(KingFrom, square(7, Rank), MoveFlag::Castling);
+
+	if ((position.castlingRights() & QueenSide) && (rooks & squareBB(square(1, Rank))) && position.isPathClear(KingFrom, square(1, Rank))
+		&& !position.isAttackedBy<Them>(square(4, Rank)) && !position.isAttackedBy<Them>(square(3, Rank)))
+		moves.add(KingFrom, square(3, Rank), MoveFlag::Castling);
+}
+
+// Generates into moves, only captures and queen promotions when CapturesOnly is set
+template<Color Us, bool CapturesOnly>
+static void generateMovesFor(const Position& position, MoveList& moves) {
+	moves.count = 0;
+	Bitboard targets = CapturesOnly ? position.pieces(~Us) : ~position.pieces(Us);
+
+	addPawnMoves<Us, CapturesOnly>(position, moves);
+	addPieceMoves<Us, PieceType::Knight>(position, moves, targets);
+	addPieceMoves<Us, PieceType::Bishop>(position, moves, targets);
+	addPieceMoves<Us, PieceType::Rook>(position, moves, targets);
+	addPieceMoves<Us, PieceType::Queen>(position, moves, targets);
+	addPieceMoves<Us, PieceType::King>(position, moves, targets);
+
+	if constexpr (!CapturesOnly) addCastlingMoves<Us>(position, moves);
+}
+
+// The only branch on the side to move, everything below it is compiled once per color
+template<bool CapturesOnly>
+static void generateMoves(const Position& position, MoveList& moves) {
+	if (position.sideToMove() == White) generateMovesFor<White, CapturesOnly>(position, moves);
+	else generateMovesFor<Black, CapturesOnly>(position, moves);
+}
+
+void generatePseudoLegalMoves(const Position& position, MoveList& moves) {
+	generateMoves<false>(position, moves);
+}
+
+// Keeps only the moves that do not leave the mover's king in check, using the position's pin and checker
+// bitboards, so no move has to be made and re-checked
+static void filterLegal(const Position& position, const MoveList& pseudo, MoveList& moves) {
+	moves.count = 0;
+	for (const Move& m : pseudo)
+		if (position.isLegal(m))
+			moves.moves[moves.count++] = m;
+}
+
+void generateLegalMoves(Position& position, MoveList& moves) {
+	MoveList pseudo;
+	generateMoves<false>(position, pseudo);
+	filterLegal(position, pseudo, moves);
+}
+
+void generateLegalCaptures(Position& position, MoveList& moves) {
+	MoveList pseudo;
+	generateMoves<true>(position, pseudo);
+	filterLegal(position, pseudo, moves);
+}
+
+bool findLegalMove(Position& position, int from, int to, Move& move) {
+	MoveList moves;
+	generateLegalMoves(position, moves);
+	for (const Move& m : moves) {
+		if (m.from() == from && m.to() == to && (m.flag() != MoveFlag::Promotion || m.promotion() == PieceType::Queen)) {
+			move = m;
+			return true;
+		}
+	}
+	return false;
+}
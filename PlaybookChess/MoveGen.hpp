@@ -0,0 +1,18 @@
+// MoveGen.hpp
+// Move generation
+
+#pragma once
+#include "Position.hpp"
+#include "Move.hpp"
+
+// All moves that follow piece movement rules for the side to move, including ones that leave the king in check
+void generatePseudoLegalMoves(const Position& position, MoveList& moves);
+
+// All legal moves for the side to move, the position is restored before returning
+void generateLegalMoves(Position& position, MoveList& moves);
+
+// Legal captures, en passant, and queen promotions only, for the quiescence search
+void generateLegalCaptures(Position& position, MoveList& moves);
+
+// Finds the legal move from one square to another, promotions default to a queen
+bool findLegalMove(Position& position, int from, int to, Move& move);
@@ -0,0 +1,68 @@
+// NetClient.cpp
+// Handles the client side of the server connection
+
+#include "NetClient.hpp"
+#include <iostream>
+#include <thread>
+
+bool NetClient::connect(const std::string& host, unsigned short port) {
+	disconnect();
+	std::optional<sf::IpAddress> address = sf::IpAddress::resolve(host);
+	if (!address) return false;
+
+	socket.setBlocking(true);
+	if (socket.connect(*address, port, sf::seconds(5)) != sf::Socket::Status::Done) return false;
+	socket.setBlocking(false); // From here on, the owner's loop never waits on the server
+	connected = true;
+	return true;
+}
+
+void NetClient::disconnect() {
+	socket.disconnect();
+	reader = FrameReader();
+	connected = false;
+}
+
+bool NetClient::send(const NetMessage& message) {
+	if (!connected) return false;
+	frame.clear();
+	appendFrame(frame, message);
+
+	// Frames are a few bytes, so a partial write only happens when the socket buffer is full and clears quickly
+	std::size_t offset = 0;
+	while (offset < frame.size()) {
+		std::size_t sent = 0;
+		sf::Socket::Status status = socket.send(frame.data() + offset, frame.size() - offset, sent);
+		offset += sent;
+		if (status == sf::Socket::Status::Done) break;
+		if (status == sf::Socket::Status::Partial || status == sf::Socket::Status::NotReady) {
+			std::this_thread::yield();
+			continue;
+		}
+		connected = false;
+		return false;
+	}
+	return true;
+}
+
+std::optional<NetMessage> NetClient::poll() {
+	while (connected) {
+		if (std::optional<NetMessage> message = reader.next()) return message;
+		if (reader.failed()) {
+			std::cerr << "ERROR: Malformed message from the server" << std::endl;
+			disconnect();
+			return std::nullopt;
+		}
+
+		std::uint8_t data[1024];
+		std::size_t received = 0;
+		sf::Socket::Status status = socket.receive(data, sizeof(data), received);
+		if (status == sf::Socket::Status::NotReady) return std::nullopt;
+		if (status != sf::Socket::Status::Done) {
+			connected = false;
+			return std::nullopt;
+		}
+		reader.append(data, received);
+	}
+	return std::nullopt;
+}
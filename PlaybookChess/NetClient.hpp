@@ -0,0 +1,28 @@
+// NetClient.hpp
+// NetClient class
+// Non-blocking connection to the game server, polled from a window loop or a selector
+
+#pragma once
+#include <SFML/Network.hpp>
+#include "NetProtocol.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+class NetClient {
+private:
+	sf::TcpSocket socket;
+	FrameReader reader;
+	std::vector<std::uint8_t> frame; // Reused for every send
+	bool connected = false;
+
+public:
+	bool connect(const std::string& host, unsigned short port); // Waits for the connection, then switches to non-blocking
+	void disconnect();
+	bool isConnected() const { return connected; }
+
+	bool send(const NetMessage& message); // Writes the whole frame, false once the connection is lost
+	std::optional<NetMessage> poll(); // Next message from the server, never blocks
+
+	sf::TcpSocket& getSocket() { return socket; } // For a selector waiting on many clients at once
+};
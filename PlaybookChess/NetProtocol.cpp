@@ -0,0 +1,85 @@
+// NetProtocol.cpp
+// Encodes and decodes network messages
+
+#include "NetProtocol.hpp"
+
+// Fields carried by each message type
+struct FrameLayout {
+	bool gameId, move, code;
+	std::uint8_t size() const { return static_cast<std::uint8_t>(1 + (gameId ? 4 : 0) + (move ? 2 : 0) + (code ? 1 : 0)); }
+};
+
+static std::optional<FrameLayout> layoutOf(NetMessageType type) {
+	switch (type) {
+	case NetMessageType::Create: return FrameLayout{ false, false, true };
+	case NetMessageType::Join:
+	case NetMessageType::Leave:
+	case NetMessageType::Started:
+	case NetMessageType::Ended: return FrameLayout{ true, false, false };
+	case NetMessageType::PlayMove: return FrameLayout{ true, true, false };
+	case NetMessageType::Created:
+	case NetMessageType::Joined:
+	case NetMessageType::Rejected: return FrameLayout{ true, false, true };
+	case NetMessageType::Moved: return FrameLayout{ true, true, true };
+	}
+	return std::nullopt;
+}
+
+const char* rejectReason(NetReject reason) {
+	switch (reason) {
+	case NetReject::NoGame: return "no such game";
+	case NetReject::GameFull: return "game is full";
+	case NetReject::NotStarted: return "waiting for an opponent";
+	case NetReject::NotYourTurn: return "not your turn";
+	case NetReject::IllegalMove: return "illegal move";
+	case NetReject::TooManyGames: return "too many open games";
+	}
+	return "unknown";
+}
+
+void appendFrame(std::vector<std::uint8_t>& out, const NetMessage& message) {
+	FrameLayout layout = *layoutOf(message.type);
+	out.push_back(layout.size());
+	out.push_back(static_cast<std::uint8_t>(message.type));
+	if (layout.gameId)
+		for (int i = 0; i < 4; i++) out.push_back(static_cast<std::uint8_t>(message.gameId >> (8 * i)));
+	if (layout.move) {
+		out.push_back(static_cast<std::uint8_t>(message.move.raw()));
+		out.push_back(static_cast<std::uint8_t>(message.move.raw() >> 8));
+	}
+	if (layout.code) out.push_back(message.code);
+}
+
+void FrameReader::append(const std::uint8_t* data, std::size_t size) {
+	if (start == buffer.size()) { // Everything so far was decoded, so the buffer can start over instead of growing
+		buffer.clear();
+		start = 0;
+	}
+	buffer.insert(buffer.end(), data, data + size);
+}
+
+std::optional<NetMessage> FrameReader::next() {
+	if (broken || buffer.size() - start < 2) return std::nullopt;
+	std::uint8_t length = buffer[start];
+	NetMessage message;
+	message.type = static_cast<NetMessageType>(buffer[start + 1]);
+	std::optional<FrameLayout> layout = layoutOf(message.type);
+	if (!layout || layout->size() != length) {
+		broken = true;
+		return std::nullopt;
+	}
+	if (buffer.size() - start < 1u + length) return std::nullopt;
+
+	const std::uint8_t* field = &buffer[start + 2];
+	if (layout->gameId) {
+		message.gameId = field[0] | field[1] << 8 | field[2] << 16 | static_cast<std::uint32_t>(field[3]) << 24;
+		field += 4;
+	}
+	if (layout->move) {
+		message.move = Move::fromRaw(static_cast<std::uint16_t>(field[0] | field[1] << 8));
+		field += 2;
+	}
+	if (layout->code) message.code = *field;
+	start += 1 + length;
+	return message;
+}
@@ -0,0 +1,62 @@
+// NetProtocol.hpp
+// Network protocol
+// Compact binary messages between the game server and its clients, with no socket code
+
+#pragma once
+#include "Move.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+constexpr unsigned short DefaultServerPort = 5225;
+
+// Each frame is a length byte counting the bytes after it, a type byte, then the type's fixed
+// little-endian fields: game id 4 bytes, move 2 bytes as Move::raw, code 1 byte, in that order.
+enum class NetMessageType : std::uint8_t {
+	// Client to server
+	Create = 0x01, // code: side wanted
+	Join = 0x02, // gameId
+	PlayMove = 0x03, // gameId, move
+	Leave = 0x04, // gameId, also sent by the server for every game of a closed connection
+
+	// Server to client
+	Created = 0x81, // gameId, code: side given
+	Joined = 0x82, // gameId, code: side given
+	Started = 0x83, // gameId, both seats are taken
+	Moved = 0x84, // gameId, move, code: GameResult after it. Sent to both players, so it is also the mover's acknowledgement.
+	Rejected = 0x85, // gameId, code: NetReject
+	Ended = 0x86, // gameId, the opponent left
+};
+
+enum class NetSide : std::uint8_t {
+	White, Black, Both // Both lets one connection play the two sides
+};
+
+enum class NetReject : std::uint8_t {
+	NoGame, GameFull, NotStarted, NotYourTurn, IllegalMove, TooManyGames
+};
+
+struct NetMessage {
+	NetMessageType type = NetMessageType::Create;
+	std::uint32_t gameId = 0;
+	Move move;
+	std::uint8_t code = 0; // Side, result, or reason, depending on the type
+};
+
+const char* rejectReason(NetReject reason); // Text for a log line
+
+void appendFrame(std::vector<std::uint8_t>& out, const NetMessage& message); // Encodes the message onto the end of out
+
+// Reassembles frames from however the stream was split into reads
+class FrameReader {
+private:
+	std::vector<std::uint8_t> buffer;
+	std::size_t start = 0; // First byte not yet decoded
+	bool broken = false;
+
+public:
+	void append(const std::uint8_t* data, std::size_t size);
+	std::optional<NetMessage> next(); // Next whole message, nothing if more bytes are needed or the stream is broken
+	bool failed() const { return broken; } // An unknown type or wrong length was seen, the connection should be dropped
+};
@@ -0,0 +1,175 @@
+// Notation.cpp
+// Builds notation strings for squares and moves
+
+#include "Notation.hpp"
+#include "MoveGen.hpp"
+
+std::string toNotation(int file, int rank) {
+	std::string notation;
+	notation += static_cast<char>('a' + file - 1);
+	notation += std::to_string(rank);
+	return notation;
+}
+
+std::string pieceSymbol(PieceType type) {
+	switch (type) {
+	case PieceType::King:	return "K";
+	case PieceType::Queen:	return "Q";
+	case PieceType::Rook:	return "R";
+	case PieceType::Bishop:	return "B";
+	case PieceType::Knight:	return "N";
+	default:				return "";
+	}
+}
+
+std::string moveToString(const Move& move) {
+	std::string s = toNotation(fileOf(move.from()), rankOf(move.from())) + toNotation(fileOf(move.to()), rankOf(move.to()));
+	if (move.flag() == MoveFlag::Promotion)
+		s += "nbrq"[static_cast<int>(move.promotion()) - 1];
+	return s;
+}
+
+bool moveFromString(Position& position, std::string_view text, Move& move) {
+	if (text.size() != 4 && text.size() != 5) return false;
+	if (text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8' || text[2] < 'a' || text[2] > 'h' || text[3] < '1' || text[3] > '8')
+		return false;
+	int from = square(text[0] - 'a' + 1, text[1] - '0');
+	int to = square(text[2] - 'a' + 1, text[3] - '0');
+
+	MoveList moves;
+	generateLegalMoves(position, moves);
+	for (const Move& m : moves) {
+		if (m.from() != from || m.to() != to) continue;
+		if (m.flag() == MoveFlag::Promotion) { // The suffix picks one of the four promotion moves
+			if (text.size() != 5 || "nbrq"[static_cast<int>(m.promotion()) - 1] != text[4]) continue;
+		}
+		else if (text.size() != 4) continue;
+		move = m;
+		return true;
+	}
+	return false;
+}
+
+std::string moveToSan(Position& position, const Move& move) {
+	std::string san;
+	PieceType type = typeOf(position.pieceOn(move.from()));
+	bool isCapture = position.pieceOn(move.to()) != NoPiece || move.flag() == MoveFlag::EnPassant;
+
+	if (move.flag() == MoveFlag::Castling) {
+		san = fileOf(move.to()) == 7 ? "O-O" : "O-O-O";
+	}
+	else {
+		san += pieceSymbol(type);
+
+		if (type == PieceType::Pawn) {
+			if (isCapture) san += static_cast<char>('a' + fileOf(move.from()) - 1);
+		}
+		else if (type != PieceType::King) {
+			// Add the file, rank, or both when another piece of the same type can reach the same square
+			MoveList moves;
+			generateLegalMoves(position, moves);
+			bool ambiguous = false, sameFile = false, sameRank = false;
+			for (const Move& m : moves) {
+				if (m.to() != move.to() || m.from() == move.from() || position.pieceOn(m.from()) != position.pieceOn(move.from())) continue;
+				ambiguous = true;
+				if (fileOf(m.from()) == fileOf(move.from())) sameFile = true;
+				if (rankOf(m.from()) == rankOf(move.from())) sameRank = true;
+			}
+			if (ambiguous) {
+				if (!sameFile) san += static_cast<char>('a' + fileOf(move.from()) - 1);
+				else if (!sameRank) san += static_cast<char>('0' + rankOf(move.from()));
+				else san += toNotation(fileOf(move.from()), rankOf(move.from()));
+			}
+		}
+
+		if (isCapture) san += "x"; // Add x to notation for a capture
+		san += toNotation(fileOf(move.to()), rankOf(move.to()));
+		if (move.flag() == MoveFlag::Promotion)
+			san += "=" + pieceSymbol(move.promotion());
+	}
+
+	// Check or mate suffix
+	UndoInfo undo;
+	position.makeMove(move, undo);
+	if (position.isInCheck(position.sideToMove())) {
+		MoveList replies;
+		generateLegalMoves(position, replies);
+		san += replies.empty() ? "#" : "+";
+	}
+	position.unmakeMove(move, undo);
+	return san;
+}
+
+// Piece type for a SAN piece letter, built from pieceSymbol so both directions use the same letters
+static bool sanPieceType(char ch, PieceType& type) {
+	static const PieceType types[5] = { PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen, PieceType::King };
+	for (PieceType t : types) {
+		if (pieceSymbol(t)[0] == ch) {
+			type = t;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool moveFromSan(Position& position, std::string_view san, Move& move) {
+	while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?'))
+		san.remove_suffix(1);
+	if (san.size() < 2) return false;
+
+	// Pseudo-legal moves are filtered by the text first, so only the few candidates pay for the legality check
+	MoveList moves;
+	generatePseudoLegalMoves(position, moves);
+
+	if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+		int toFile = san.size() == 3 ? 7 : 3; // King's destination file
+		for (const Move& m : moves) {
+			if (m.flag() == MoveFlag::Castling && fileOf(m.to()) == toFile && position.isLegal(m)) {
+				move = m;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Piece letter first, pawns have none
+	PieceType type = PieceType::Pawn;
+	if (sanPieceType(san.front(), type)) san.remove_prefix(1);
+
+	// Promotion last, as =Q or Q
+	bool isPromotion = false;
+	PieceType promotion = PieceType::Queen;
+	if (type == PieceType::Pawn && sanPieceType(san.back(), promotion)) {
+		isPromotion = true;
+		san.remove_suffix(1);
+		if (!san.empty() && san.back() == '=') san.remove_suffix(1);
+	}
+
+	// Destination is the last square, anything before it is disambiguation or a capture mark
+	if (san.size() < 2) return false;
+	char toFileCh = san[san.size() - 2], toRankCh = san[san.size() - 1];
+	if (toFileCh < 'a' || toFileCh > 'h' || toRankCh < '1' || toRankCh > '8') return false;
+	int to = square(toFileCh - 'a' + 1, toRankCh - '0');
+	san.remove_suffix(2);
+
+	int fromFile = 0, fromRank = 0; // 0 when not given
+	for (char ch : san) {
+		if (ch >= 'a' && ch <= 'h') fromFile = ch - 'a' + 1;
+		else if (ch >= '1' && ch <= '8') fromRank = ch - '0';
+		else if (ch != 'x' && ch != '-' && ch != ':') return false;
+	}
+
+	int matches = 0;
+	for (const Move& m : moves) {
+		if (m.to() != to || typeOf(position.pieceOn(m.from())) != type) continue;
+		if (fromFile && fileOf(m.from()) != fromFile) continue;
+		if (fromRank && rankOf(m.from()) != fromRank) continue;
+		if ((m.flag() == MoveFlag::Promotion) != isPromotion) continue;
+		if (isPromotion && m.promotion() != promotion) continue;
+		if (m.flag() == MoveFlag::Castling) continue; // Castling is only written with O-O
+		if (!position.isLegal(m)) continue;
+		move = m;
+		matches++;
+	}
+	return matches == 1;
+}
@@ -0,0 +1,20 @@
+// Notation.hpp
+// Square, piece, and move notation
+
+#pragma once
+#include "Position.hpp"
+#include "Move.hpp"
+#include <string>
+#include <string_view>
+
+std::string toNotation(int file, int rank); // Convert file/rank to chess notation, such as e4
+std::string pieceSymbol(PieceType type); // Convert piece type to notation, empty for pawns
+std::string moveToString(const Move& move); // Coordinate notation, such as e2e4 or e7e8q
+bool moveFromString(Position& position, std::string_view text, Move& move); // Parses coordinate notation, false unless it names a legal move
+
+// Standard algebraic notation for a legal move in the given position, including check and mate suffixes
+std::string moveToSan(Position& position, const Move& move);
+
+// Parses standard algebraic notation in place, without building strings. Accepts check, mate, and annotation
+// suffixes, castling with O or 0, and promotions with or without '='. False unless exactly one legal move matches.
+bool moveFromSan(Position& position, std::string_view san, Move& move);
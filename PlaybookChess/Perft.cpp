@@ -0,0 +1,40 @@
+// Perft.cpp
+// Handles perft counting
+
+#include "Perft.hpp"
+#include "MoveGen.hpp"
+
+std::uint64_t perft(Position& position, int depth) {
+	if (depth <= 0) return 1;
+
+	MoveList moves;
+	generateLegalMoves(position, moves);
+	if (depth == 1) return moves.size(); // Leaf moves are counted without being made
+
+	std::uint64_t nodes = 0;
+	for (const Move& m : moves) {
+		UndoInfo undo;
+		position.makeMove(m, undo);
+		nodes += perft(position, depth - 1);
+		position.unmakeMove(m, undo);
+	}
+	return nodes;
+}
+
+const std::vector<PerftReference>& perftReferences() {
+	static const std::vector<PerftReference> references = {
+		{ "Start position", StartFen,
+			{ 20, 400, 8902, 197281, 4865609, 119060324 } },
+		{ "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			{ 48, 2039, 97862, 4085603, 193690690 } },
+		{ "Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+			{ 14, 191, 2812, 43238, 674624, 11030083 } },
+		{ "Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+			{ 6, 264, 9467, 422333, 15833292 } },
+		{ "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+			{ 44, 1486, 62379, 2103487, 89941194 } },
+		{ "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+			{ 46, 2079, 89890, 3894594, 164075551 } },
+	};
+	return references;
+}
@@ -0,0 +1,20 @@
+// Perft.hpp
+// Move generation node counting and reference positions
+
+#pragma once
+#include "Position.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct PerftReference {
+	std::string name;
+	std::string fen;
+	std::vector<std::uint64_t> expected; // Node counts for depth 1, 2, 3, ...
+};
+
+// Counts leaf nodes of the legal move tree, the position is unchanged on return
+std::uint64_t perft(Position& position, int depth);
+
+// Standard published positions with known node counts
+const std::vector<PerftReference>& perftReferences();
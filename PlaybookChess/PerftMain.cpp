@@ -0,0 +1,104 @@
+// PerftMain.cpp
+// Headless perft tool, no window or SFML needed
+// Usage: perft <depth> [fen]      divide and node count for one position, default is the start position
+//        perft --suite [depth]    checks the reference positions up to depth, default 4
+
+#include "Perft.hpp"
+#include "MoveGen.hpp"
+#include "Notation.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Prints the node count below each root move, then the total
+static int runDivide(const std::string& fen, int depth) {
+	Position position;
+	if (!position.setFromFen(fen)) {
+		std::cerr << "ERROR: Invalid FEN: " << fen << std::endl;
+		return 1;
+	}
+
+	MoveList moves;
+	generateLegalMoves(position, moves);
+
+	auto start = Clock::now();
+	std::uint64_t total = 0;
+	for (const Move& m : moves) {
+		UndoInfo undo;
+		position.makeMove(m, undo);
+		std::uint64_t nodes = perft(position, depth - 1);
+		position.unmakeMove(m, undo);
+		std::cout << moveToString(m) << ": " << nodes << "\n";
+		total += nodes;
+	}
+	double seconds = secondsSince(start);
+
+	std::cout << "\nNodes: " << total << "\n";
+	std::cout << "Time: " << seconds << " s\n";
+	std::cout << "NPS: " << static_cast<std::uint64_t>(total / (seconds > 0 ? seconds : 1e-9)) << std::endl;
+	return 0;
+}
+
+// Runs every reference position up to maxDepth and reports mismatches
+static int runSuite(int maxDepth) {
+	std::uint64_t totalNodes = 0;
+	double totalSeconds = 0;
+	int failures = 0;
+
+	for (const PerftReference& ref : perftReferences()) {
+		Position position;
+		position.setFromFen(ref.fen);
+
+		for (int depth = 1; depth <= maxDepth && depth <= static_cast<int>(ref.expected.size()); depth++) {
+			auto start = Clock::now();
+			std::uint64_t nodes = perft(position, depth);
+			double seconds = secondsSince(start);
+			totalNodes += nodes;
+			totalSeconds += seconds;
+
+			bool ok = nodes == ref.expected[depth - 1];
+			if (!ok) failures++;
+			std::cout << (ok ? "PASS " : "FAIL ") << ref.name << " depth " << depth << ": " << nodes;
+			if (!ok) std::cout << " (expected " << ref.expected[depth - 1] << ")";
+			std::cout << "\n";
+		}
+	}
+
+	std::cout << "\nNodes: " << totalNodes << "\n";
+	std::cout << "Time: " << totalSeconds << " s\n";
+	std::cout << "NPS: " << static_cast<std::uint64_t>(totalNodes / (totalSeconds > 0 ? totalSeconds : 1e-9)) << "\n";
+	std::cout << (failures ? std::to_string(failures) + " FAILED" : "All passed") << std::endl;
+	return failures ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: perft <depth> [fen]\n       perft --suite [depth]" << std::endl;
+		return 1;
+	}
+
+	std::string first = argv[1];
+	if (first == "--suite")
+		return runSuite(argc > 2 ? std::atoi(argv[2]) : 4);
+
+	int depth = std::atoi(argv[1]);
+	if (depth < 1) {
+		std::cerr << "ERROR: Depth must be at least 1" << std::endl;
+		return 1;
+	}
+
+	// The FEN may be passed as one quoted argument or as separate words
+	std::string fen;
+	for (int i = 2; i < argc; i++) {
+		if (!fen.empty()) fen += ' ';
+		fen += argv[i];
+	}
+	return runDivide(fen.empty() ? StartFen : fen, depth);
+}
@@ -0,0 +1,187 @@
+// PgnArchive.cpp
+// Handles PGN indexing, the saved index file, and decoding one game for replay
+
+#include "PgnArchive.hpp"
+#include "Validate.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <system_error>
+
+static_assert(sizeof(PgnGameEntry) == 40, "Index entries are saved as raw bytes");
+
+constexpr std::uint32_t PgnIndexVersion = 1;
+
+// Index file header, followed by one PgnGameEntry per game
+struct PgnIndexHeader {
+	char magic[4];
+	std::uint32_t version;
+	std::uint64_t sourceSize; // The PGN file this index was built from
+	std::int64_t sourceTime;
+	std::uint64_t games;
+};
+
+static const std::string_view TagNames[PgnTagCount] = { "Event", "Date", "White", "Black", "Result", "FEN" };
+
+std::string PgnArchive::indexPath(const std::string& pgnPath) {
+	return pgnPath + ".idx";
+}
+
+bool PgnArchive::open(const std::string& path, std::ostream* log) {
+	built.clear();
+	entries = nullptr;
+	count = 0;
+	indexFile.close();
+	if (!file.open(path)) return false;
+
+	std::error_code ec;
+	std::int64_t sourceTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+	std::string index = indexPath(path);
+	auto start = std::chrono::steady_clock::now();
+	if (loadIndex(index, file.size(), sourceTime)) {
+		if (log) *log << "Loaded index of " << count << " games" << std::endl;
+		return true;
+	}
+
+	buildIndex();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (log) *log << "Indexed " << count << " games in " << seconds << " s" << std::endl;
+	if (!saveIndex(index, file.size(), sourceTime) && log) // Still usable, it is just built again next time
+		*log << "ERROR: Could not write " << index << std::endl;
+	return true;
+}
+
+bool PgnArchive::loadIndex(const std::string& path, std::uint64_t sourceSize, std::int64_t sourceTime) {
+	if (!indexFile.open(path) || indexFile.size() < sizeof(PgnIndexHeader)) return false;
+
+	PgnIndexHeader header;
+	std::memcpy(&header, indexFile.data(), sizeof(header));
+	if (std::memcmp(header.magic, "PCGI", 4) != 0 || header.version != PgnIndexVersion || header.sourceSize != sourceSize
+		|| header.sourceTime != sourceTime || indexFile.size() != sizeof(header) + header.games * sizeof(PgnGameEntry)) {
+		indexFile.close();
+		return false;
+	}
+	entries = reinterpret_cast<const PgnGameEntry*>(indexFile.data() + sizeof(header));
+	count = static_cast<std::size_t>(header.games);
+	return true;
+}
+
+bool PgnArchive::saveIndex(const std::string& path, std::uint64_t sourceSize, std::int64_t sourceTime) const {
+	PgnIndexHeader header{};
+	std::memcpy(header.magic, "PCGI", 4);
+	header.version = PgnIndexVersion;
+	header.sourceSize = sourceSize;
+	header.sourceTime = sourceTime;
+	header.games = built.size();
+
+	std::ofstream out(path, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(built.data()), static_cast<std::streamsize>(built.size() * sizeof(PgnGameEntry)));
+	return static_cast<bool>(out);
+}
+
+// One pass over the lines. A tag line after movetext starts the next game, the same boundary the validator uses,
+// and only the tags shown in the viewer are remembered.
+void PgnArchive::buildIndex() {
+	std::string_view text = file.view();
+	bool inMovetext = true; // So the first tag line starts a game
+	std::size_t pos = 0;
+
+	while (pos < text.size()) {
+		std::size_t end = text.find('\n', pos);
+		if (end == std::string_view::npos) end = text.size();
+		std::string_view line = text.substr(pos, end - pos);
+
+		if (!line.empty() && line[0] == '[') {
+			if (inMovetext) {
+				if (!built.empty()) built.back().length = static_cast<std::uint32_t>(pos - built.back().offset);
+				built.emplace_back();
+				built.back().offset = pos;
+				inMovetext = false;
+			}
+
+			std::size_t nameEnd = line.find_first_of(" \t");
+			std::size_t open = line.find('"'), close = line.rfind('"');
+			if (nameEnd != std::string_view::npos && open != std::string_view::npos && close > open) {
+				std::string_view name = line.substr(1, nameEnd - 1);
+				PgnGameEntry& entry = built.back();
+				std::size_t valueStart = pos + open + 1 - entry.offset;
+				for (int t = 0; t < PgnTagCount; t++) {
+					if (name != TagNames[t] || valueStart + (close - open - 1) > 0xFFFF) continue;
+					entry.tagStart[t] = static_cast<std::uint16_t>(valueStart);
+					entry.tagLength[t] = static_cast<std::uint16_t>(close - open - 1);
+				}
+			}
+		}
+		else if (!built.empty() && line.find_first_not_of(" \t\r") != std::string_view::npos) {
+			inMovetext = true;
+		}
+		pos = end + 1;
+	}
+	if (!built.empty()) built.back().length = static_cast<std::uint32_t>(text.size() - built.back().offset);
+
+	entries = built.data();
+	count = built.size();
+}
+
+std::string_view PgnArchive::text(std::size_t game) const {
+	if (game >= count) return {};
+	return file.view().substr(static_cast<std::size_t>(entries[game].offset), entries[game].length);
+}
+
+std::string_view PgnArchive::tag(std::size_t game, PgnTag tag) const {
+	if (game >= count) return {};
+	const PgnGameEntry& entry = entries[game];
+	int t = static_cast<int>(tag);
+	return file.view().substr(static_cast<std::size_t>(entry.offset) + entry.tagStart[t], entry.tagLength[t]);
+}
+
+bool GameReplay::load(const PgnArchive& archive, std::size_t game) {
+	moves.clear();
+	checkpoints.clear();
+	error.clear();
+	ply = 0;
+
+	std::string_view fen = archive.tag(game, PgnTag::Fen);
+	Position start;
+	if (game >= archive.size() || !start.setFromFen(fen.empty() ? StartFen : std::string(fen))) {
+		error = "invalid start position";
+		current = Position();
+		return false;
+	}
+
+	// The validator's parser replays the game, keeping every move and each checkpoint on the way
+	ValidationReport report = validateText(archive.text(game), InputFormat::Pgn, 1, false,
+		[this](const Position& before, const Move& move, int) {
+			if (moves.size() % CheckpointInterval == 0) checkpoints.push_back(before);
+			moves.push_back(move);
+		});
+	if (!report.issues.empty()) error = report.issues.front().message;
+	if (checkpoints.empty()) checkpoints.push_back(start);
+	current = checkpoints.front();
+	return true;
+}
+
+bool GameReplay::forward() {
+	if (ply >= plyCount()) return false;
+	UndoInfo undo;
+	current.makeMove(moves[ply++], undo);
+	return true;
+}
+
+bool GameReplay::back() {
+	if (ply == 0) return false;
+	seek(ply - 1);
+	return true;
+}
+
+void GameReplay::seek(int target) {
+	target = std::clamp(target, 0, plyCount());
+	std::size_t checkpoint = std::min(checkpoints.size() - 1, static_cast<std::size_t>(target / CheckpointInterval));
+	current = checkpoints[checkpoint];
+	ply = static_cast<int>(checkpoint) * CheckpointInterval;
+	while (ply < target) forward();
+}
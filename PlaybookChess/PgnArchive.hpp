@@ -0,0 +1,76 @@
+// PgnArchive.hpp
+// PgnArchive and GameReplay classes
+// Browses PGN files too large to parse up front: a saved index of game offsets and tags, and one game decoded at a time
+
+#pragma once
+#include "MappedFile.hpp"
+#include "Move.hpp"
+#include "Position.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class PgnTag {
+	Event, Date, White, Black, Result, Fen
+};
+constexpr int PgnTagCount = 6;
+
+// One game in the index. Tag values are spans from the start of the game, so the index holds no text of its own.
+struct PgnGameEntry {
+	std::uint64_t offset = 0; // First byte of the game's tags in the file
+	std::uint32_t length = 0; // Bytes up to the next game
+	std::uint16_t tagStart[PgnTagCount] = {}; // By PgnTag, a zero length means missing or too far into the game to store
+	std::uint16_t tagLength[PgnTagCount] = {};
+};
+
+// The PGN file and its index stay memory mapped, so opening touches only the index header and
+// showing a game reads only that game's bytes
+class PgnArchive {
+private:
+	MappedFile file;
+	MappedFile indexFile; // Saved index, when it matched the PGN file
+	std::vector<PgnGameEntry> built; // Index built in this run, otherwise
+	const PgnGameEntry* entries = nullptr;
+	std::size_t count = 0;
+
+	bool loadIndex(const std::string& path, std::uint64_t sourceSize, std::int64_t sourceTime);
+	void buildIndex();
+	bool saveIndex(const std::string& path, std::uint64_t sourceSize, std::int64_t sourceTime) const;
+
+public:
+	// Maps the file and its index beside it, building and saving the index if it is missing or older than the file
+	bool open(const std::string& path, std::ostream* log = nullptr);
+	static std::string indexPath(const std::string& pgnPath); // pgnPath + ".idx"
+
+	std::size_t size() const { return count; }
+	std::string_view text(std::size_t game) const; // The whole game, tags and movetext
+	std::string_view tag(std::size_t game, PgnTag tag) const; // Empty if the game does not have it
+};
+
+// One decoded game. The position before every CheckpointInterval-th move is kept, so reaching any ply
+// makes at most CheckpointInterval - 1 moves, in either direction.
+class GameReplay {
+private:
+	std::vector<Move> moves;
+	std::vector<Position> checkpoints; // Position before move i * CheckpointInterval
+	Position current;
+	int ply = 0;
+	std::string error; // Why the game stopped early, empty if every move was legal
+
+public:
+	static constexpr int CheckpointInterval = 16;
+
+	bool load(const PgnArchive& archive, std::size_t game); // Parses only this game, false if its start position is invalid
+	int plyCount() const { return static_cast<int>(moves.size()); }
+	int currentPly() const { return ply; }
+	const Position& position() const { return current; }
+	const Move& moveAt(int index) const { return moves[index]; } // Move index leads from ply index to index + 1
+	const std::string& getError() const { return error; }
+
+	bool forward(); // One move on, false at the end
+	bool back(); // One move back, from the nearest checkpoint, false at the start
+	void seek(int target); // Clamped to the game
+};
@@ -0,0 +1,66 @@
+// PgnIndexMain.cpp
+// Headless PGN archive tool, builds the index the viewer uses and shows any game and ply from it
+// Usage: pgnindex <file.pgn> [--game n] [--ply p] [--rebuild]
+// Games are counted from 1, a ply past the end shows the final position.
+
+#include "Notation.hpp"
+#include "PgnArchive.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: pgnindex <file.pgn> [--game n] [--ply p] [--rebuild]" << std::endl;
+		return 1;
+	}
+	std::string path = argv[1];
+	std::size_t game = 1;
+	int ply = 0;
+	bool rebuild = false;
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--rebuild") rebuild = true;
+		else if (arg == "--game" && i + 1 < argc) game = std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--ply" && i + 1 < argc) ply = std::atoi(argv[++i]);
+	}
+
+	if (rebuild) {
+		std::error_code ec;
+		std::filesystem::remove(PgnArchive::indexPath(path), ec);
+	}
+	auto start = std::chrono::steady_clock::now();
+	PgnArchive archive;
+	if (!archive.open(path, &std::cout)) {
+		std::cerr << "ERROR: Could not open " << path << std::endl;
+		return 1;
+	}
+	auto opened = std::chrono::steady_clock::now();
+	std::cout << "Open: " << std::chrono::duration<double, std::milli>(opened - start).count() << " ms" << std::endl;
+	if (game < 1 || game > archive.size()) {
+		std::cerr << "ERROR: Game " << game << " is not in the archive" << std::endl;
+		return 1;
+	}
+
+	GameReplay replay;
+	bool loaded = replay.load(archive, game - 1);
+	auto decoded = std::chrono::steady_clock::now();
+	replay.seek(ply);
+	auto sought = std::chrono::steady_clock::now();
+
+	std::cout << "Game " << game << " of " << archive.size() << ": " << archive.tag(game - 1, PgnTag::White) << " - "
+		<< archive.tag(game - 1, PgnTag::Black) << " " << archive.tag(game - 1, PgnTag::Result) << " ("
+		<< archive.tag(game - 1, PgnTag::Event) << ", " << archive.tag(game - 1, PgnTag::Date) << ")" << std::endl;
+	if (!replay.getError().empty()) std::cout << "Stopped early: " << replay.getError() << std::endl;
+	if (!loaded) return 1;
+	std::cout << "Decoded " << replay.plyCount() << " plies in " << std::chrono::duration<double, std::milli>(decoded - opened).count()
+		<< " ms, seek to ply " << replay.currentPly() << " in " << std::chrono::duration<double, std::micro>(sought - decoded).count() << " us" << std::endl;
+
+	Position position = replay.position();
+	std::cout << "FEN: " << position.toFen() << std::endl;
+	if (replay.currentPly() < replay.plyCount())
+		std::cout << "Next move: " << moveToSan(position, replay.moveAt(replay.currentPly())) << std::endl;
+	return 0;
+}
@@ -0,0 +1,48 @@
+// PieceTable.cpp
+// Handles piece table class
+
+#include "PieceTable.hpp"
+
+// PieceTable constructor
+PieceTable::PieceTable() {
+	clear();
+}
+
+void PieceTable::clear() {
+	aliveMask = 0;
+	used = 0;
+	slotOn.fill(-1);
+}
+
+int PieceTable::add(int file, int rank, bool isWhite, PieceType type) {
+	if (used >= Capacity) return -1;
+	int slot = used++;
+	files[slot] = static_cast<std::int8_t>(file);
+	ranks[slot] = static_cast<std::int8_t>(rank);
+	white[slot] = isWhite;
+	types[slot] = type;
+	aliveMask |= 1u << slot;
+	slotOn[square(file, rank)] = static_cast<std::int8_t>(slot);
+	return slot;
+}
+
+void PieceTable::move(int slot, int file, int rank) {
+	slotOn[square(files[slot], ranks[slot])] = -1;
+	files[slot] = static_cast<std::int8_t>(file);
+	ranks[slot] = static_cast<std::int8_t>(rank);
+	slotOn[square(file, rank)] = static_cast<std::int8_t>(slot);
+}
+
+void PieceTable::capture(int slot) {
+	aliveMask &= ~(1u << slot);
+	slotOn[square(files[slot], ranks[slot])] = -1;
+}
+
+void PieceTable::promote(int slot, PieceType type) {
+	types[slot] = type;
+}
+
+void PieceTable::appendVertices(sf::VertexArray& vertices) const {
+	for (std::uint32_t mask = aliveMask; mask; mask &= mask - 1)
+		piece(lsb(mask)).appendVertices(vertices);
+}
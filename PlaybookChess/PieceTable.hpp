@@ -0,0 +1,44 @@
+// PieceTable.hpp
+// PieceTable class
+// Fixed-capacity storage for the drawn pieces. Each piece keeps its slot for the whole game, captures only clear its alive bit.
+
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Piece.hpp"
+#include <array>
+#include <cstdint>
+
+class PieceTable {
+public:
+	static constexpr int Capacity = 32; // Promotions reuse the pawn's slot, so a game never needs more
+
+private:
+	// Struct of arrays, so a scan over one field stays within a cache line or two
+	std::array<std::int8_t, Capacity> files{};
+	std::array<std::int8_t, Capacity> ranks{};
+	std::array<bool, Capacity> white{};
+	std::array<PieceType, Capacity> types{};
+	std::uint32_t aliveMask = 0; // Bit per slot
+	int used = 0; // Slots handed out since the last clear
+	std::array<std::int8_t, 64> slotOn; // Slot of the live piece on each square, -1 if empty
+
+public:
+	PieceTable(); // Constructor, starts empty
+	void clear();
+	int add(int file, int rank, bool isWhite, PieceType type); // Returns the new slot, -1 if the table is full
+
+	int slotAt(int file, int rank) const { return slotOn[square(file, rank)]; } // -1 if the square is empty
+	bool isAlive(int slot) const { return slot >= 0 && slot < Capacity && (aliveMask >> slot & 1); }
+	std::uint32_t alive() const { return aliveMask; }
+	int getFile(int slot) const { return files[slot]; }
+	int getRank(int slot) const { return ranks[slot]; }
+	bool isWhitePiece(int slot) const { return white[slot]; }
+	PieceType getType(int slot) const { return types[slot]; }
+	Piece piece(int slot) const { return Piece(files[slot], ranks[slot], white[slot], types[slot]); } // Value copy for move validation
+
+	void move(int slot, int file, int rank); // Destination must be empty
+	void capture(int slot);
+	void promote(int slot, PieceType type);
+
+	void appendVertices(sf::VertexArray& vertices) const; // Adds a textured quad for every live piece
+};
@@ -0,0 +1,386 @@
+// Position.cpp
+// Handles position class
+
+#include "Position.hpp"
+#include "Zobrist.hpp"
+#include <cstring>
+#include <sstream>
+
+const char* const StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static const char pieceChars[] = "PNBRQKpnbrqk"; // FEN letter for each piece code
+
+// Position constructor
+Position::Position() {
+	clear();
+}
+
+void Position::clear() {
+	for (auto& b : colorBB) b = 0;
+	for (auto& b : typeBB) b = 0;
+	mailbox.fill(NoPiece);
+	side = White;
+	castling = NoCastling;
+	epSquare = -1;
+	halfmoveClock = 0;
+	fullmoveNumber = 1;
+	key = 0;
+	checkersBB = 0;
+	pinnedBB = 0;
+}
+
+bool Position::setFromFen(const std::string& fen) {
+	clear();
+	std::istringstream in(fen);
+	std::string placement, sideField, castlingField, epField;
+	if (!(in >> placement >> sideField >> castlingField >> epField)) return false;
+	if (!(in >> halfmoveClock >> fullmoveNumber)) { // Move counters are optional
+		halfmoveClock = 0;
+		fullmoveNumber = 1;
+	}
+
+	// Piece placement, listed from rank 8 down to rank 1
+	int file = 1, rank = 8;
+	for (char ch : placement) {
+		if (ch == '/') {
+			rank--;
+			file = 1;
+		}
+		else if (ch >= '1' && ch <= '8') {
+			file += ch - '0';
+		}
+		else {
+			const char* found = std::strchr(pieceChars, ch);
+			if (!found || file > 8 || rank < 1) { clear(); return false; }
+			PieceCode p = static_cast<PieceCode>(found - pieceChars);
+			addPiece(square(file, rank), colorOf(p), typeOf(p));
+			file++;
+		}
+	}
+
+	if (sideField != "w" && sideField != "b") { clear(); return false; }
+	setSideToMove(sideField == "w" ? White : Black);
+
+	int rights = NoCastling;
+	for (char ch : castlingField) {
+		if (ch == 'K') rights |= WhiteKingSide;
+		else if (ch == 'Q') rights |= WhiteQueenSide;
+		else if (ch == 'k') rights |= BlackKingSide;
+		else if (ch == 'q') rights |= BlackQueenSide;
+	}
+	for (Color c : { White, Black }) { // A right only stands while its king and rook are on their home squares
+		int rank = relativeRank(c, 1);
+		int kingSide = c == White ? WhiteKingSide : BlackKingSide;
+		int queenSide = c == White ? WhiteQueenSide : BlackQueenSide;
+		if (!(pieces(c, PieceType::King) & squareBB(square(5, rank)))) rights &= ~(kingSide | queenSide);
+		if (!(pieces(c, PieceType::Rook) & squareBB(square(8, rank)))) rights &= ~kingSide;
+		if (!(pieces(c, PieceType::Rook) & squareBB(square(1, rank)))) rights &= ~queenSide;
+	}
+	setCastlingRights(rights);
+
+	if (epField != "-") {
+		if (epField.size() != 2 || epField[0] < 'a' || epField[0] > 'h' || epField[1] < '1' || epField[1] > '8') { clear(); return false; }
+		int ep = square(epField[0] - 'a' + 1, epField[1] - '0');
+		if (pawnAttacks(~side, ep) & pieces(side, PieceType::Pawn)) // Same rule as makeMove, so equal positions get equal keys
+			setEnPassantSquare(ep);
+	}
+	updateCheckInfo();
+	return true;
+}
+
+std::string Position::toFen() const {
+	std::string fen;
+	for (int rank = 8; rank >= 1; rank--) {
+		int empty = 0;
+		for (int file = 1; file <= 8; file++) {
+			PieceCode p = mailbox[square(file, rank)];
+			if (p == NoPiece) {
+				empty++;
+				continue;
+			}
+			if (empty) fen += static_cast<char>('0' + empty);
+			empty = 0;
+			fen += pieceChars[p];
+		}
+		if (empty) fen += static_cast<char>('0' + empty);
+		if (rank > 1) fen += '/';
+	}
+
+	fen += side == White ? " w " : " b ";
+	if (castling == NoCastling) fen += '-';
+	if (castling & WhiteKingSide) fen += 'K';
+	if (castling & WhiteQueenSide) fen += 'Q';
+	if (castling & BlackKingSide) fen += 'k';
+	if (castling & BlackQueenSide) fen += 'q';
+
+	fen += ' ';
+	if (epSquare == -1) fen += '-';
+	else {
+		fen += static_cast<char>('a' + fileOf(epSquare) - 1);
+		fen += static_cast<char>('0' + rankOf(epSquare));
+	}
+	fen += " " + std::to_string(halfmoveClock) + " " + std::to_string(fullmoveNumber);
+	return fen;
+}
+
+std::uint64_t Position::computeKey() const {
+	std::uint64_t k = 0;
+	for (int sq = 0; sq < 64; sq++)
+		if (mailbox[sq] != NoPiece) k ^= ZobristPiece[mailbox[sq]][sq];
+	k ^= ZobristCastling[castling];
+	if (epSquare != -1) k ^= ZobristEnPassant[fileOf(epSquare) - 1];
+	if (side == Black) k ^= ZobristSide;
+	return k;
+}
+
+void Position::setSideToMove(Color c) {
+	if (c != side) key ^= ZobristSide;
+	side = c;
+	updateCheckInfo();
+}
+
+void Position::setCastlingRights(int rights) {
+	key ^= ZobristCastling[castling] ^ ZobristCastling[rights];
+	castling = rights;
+}
+
+void Position::setEnPassantSquare(int sq) {
+	if (epSquare != -1) key ^= ZobristEnPassant[fileOf(epSquare) - 1];
+	if (sq != -1) key ^= ZobristEnPassant[fileOf(sq) - 1];
+	epSquare = sq;
+}
+
+void Position::addPiece(int sq, Color c, PieceType t) {
+	colorBB[c] |= squareBB(sq);
+	typeBB[static_cast<int>(t)] |= squareBB(sq);
+	mailbox[sq] = makePiece(c, t);
+	key ^= ZobristPiece[mailbox[sq]][sq];
+}
+
+void Position::removePiece(int sq) {
+	PieceCode p = mailbox[sq];
+	if (p == NoPiece) return;
+	colorBB[colorOf(p)] &= ~squareBB(sq);
+	typeBB[static_cast<int>(typeOf(p))] &= ~squareBB(sq);
+	mailbox[sq] = NoPiece;
+	key ^= ZobristPiece[p][sq];
+}
+
+void Position::movePiece(int from, int to) {
+	PieceCode p = mailbox[from];
+	Bitboard fromTo = squareBB(from) | squareBB(to); // Toggling both bits moves the piece in one operation
+	colorBB[colorOf(p)] ^= fromTo;
+	typeBB[static_cast<int>(typeOf(p))] ^= fromTo;
+	mailbox[to] = p;
+	mailbox[from] = NoPiece;
+	key ^= ZobristPiece[p][from] ^ ZobristPiece[p][to];
+}
+
+int Position::kingSquare(Color c) const {
+	Bitboard king = pieces(c, PieceType::King);
+	return king ? lsb(king) : -1;
+}
+
+// The movement rule for one color and piece type, with the direction and start rank as constants
+template<Color Us, PieceType Pt>
+bool Position::isValidMoveFor(int from, int to) const {
+	Bitboard target = squareBB(to);
+	if (pieces(Us) & target) // Checks if square is occupied by the same color, which includes from itself
+		return false;
+
+	if constexpr (Pt == PieceType::Pawn) {
+		constexpr int Up = pawnPush(Us);
+		constexpr int StartRank = relativeRank(Us, 2); // Starting rank for the double move
+
+		if (to == from + Up) // Move one space forward
+			return !isOccupied(to);
+		if (to == from + 2 * Up && rankOf(from) == StartRank) // Double move, both squares must be empty
+			return (occupied() & (target | squareBB(from + Up))) == 0;
+		return (pawnAttacks<Us>(from) & pieces(~Us) & target) != 0; // Diagonal capturing
+	}
+	else {
+		return (attacks<Pt>(from, occupied()) & target) != 0; // One table lookup against the destination bit
+	}
+}
+
+bool Position::isValidMove(int from, int to) const {
+	switch (mailbox[from]) { // A single jump on the piece code, an empty square falls through to false
+	case makePiece(White, PieceType::Pawn): return isValidMoveFor<White, PieceType::Pawn>(from, to);
+	case makePiece(White, PieceType::Knight): return isValidMoveFor<White, PieceType::Knight>(from, to);
+	case makePiece(White, PieceType::Bishop): return isValidMoveFor<White, PieceType::Bishop>(from, to);
+	case makePiece(White, PieceType::Rook): return isValidMoveFor<White, PieceType::Rook>(from, to);
+	case makePiece(White, PieceType::Queen): return isValidMoveFor<White, PieceType::Queen>(from, to);
+	case makePiece(White, PieceType::King): return isValidMoveFor<White, PieceType::King>(from, to);
+	case makePiece(Black, PieceType::Pawn): return isValidMoveFor<Black, PieceType::Pawn>(from, to);
+	case makePiece(Black, PieceType::Knight): return isValidMoveFor<Black, PieceType::Knight>(from, to);
+	case makePiece(Black, PieceType::Bishop): return isValidMoveFor<Black, PieceType::Bishop>(from, to);
+	case makePiece(Black, PieceType::Rook): return isValidMoveFor<Black, PieceType::Rook>(from, to);
+	case makePiece(Black, PieceType::Queen): return isValidMoveFor<Black, PieceType::Queen>(from, to);
+	case makePiece(Black, PieceType::King): return isValidMoveFor<Black, PieceType::King>(from, to);
+	}
+
+	return false;
+}
+
+Bitboard Position::attackersTo(int sq, Bitboard occ) const {
+	// Looks outward from sq with each piece's movement, any matching piece found is an attacker
+	return (pawnAttacks(Black, sq) & pieces(White, PieceType::Pawn))
+		| (pawnAttacks(White, sq) & pieces(Black, PieceType::Pawn))
+		| (knightAttacks(sq) & pieces(PieceType::Knight))
+		| (kingAttacks(sq) & pieces(PieceType::King))
+		| (bishopAttacks(sq, occ) & (pieces(PieceType::Bishop) | pieces(PieceType::Queen)))
+		| (rookAttacks(sq, occ) & (pieces(PieceType::Rook) | pieces(PieceType::Queen)));
+}
+
+bool Position::isSquareAttacked(int sq, Color by) const {
+	return by == White ? isAttackedBy<White>(sq) : isAttackedBy<Black>(sq);
+}
+
+bool Position::isInCheck(Color c) const {
+	if (c == side) return checkersBB != 0; // Already known for the side to move
+	int kingSq = kingSquare(c);
+	return kingSq != -1 && isSquareAttacked(kingSq, ~c);
+}
+
+void Position::updateCheckInfo() {
+	checkersBB = 0;
+	pinnedBB = 0;
+	int kingSq = kingSquare(side);
+	if (kingSq == -1) return;
+
+	// Reverse attack query, every piece type is looked up from the king's square
+	checkersBB = attackersTo(kingSq, occupied()) & pieces(~side);
+
+	// Enemy sliders that would attack the king on an empty board pin a lone friendly blocker
+	Bitboard straight = pieces(~side, PieceType::Rook) | pieces(~side, PieceType::Queen);
+	Bitboard diagonal = pieces(~side, PieceType::Bishop) | pieces(~side, PieceType::Queen);
+	Bitboard snipers = (rookAttacks(kingSq, 0) & straight) | (bishopAttacks(kingSq, 0) & diagonal);
+	while (snipers) {
+		Bitboard blockers = betweenBB(kingSq, popLsb(snipers)) & occupied();
+		if (blockers && !(blockers & (blockers - 1)) && (blockers & pieces(side)))
+			pinnedBB |= blockers;
+	}
+}
+
+bool Position::isLegal(const Move& m) const {
+	Color us = side;
+	int kingSq = kingSquare(us);
+	if (kingSq == -1) return true;
+	Bitboard from = squareBB(m.from()), to = squareBB(m.to());
+
+	if (m.flag() == MoveFlag::EnPassant) { // Two pawns leave the rank at once, so test the resulting occupancy directly
+		int capSq = m.to() - (us == White ? 8 : -8);
+		Bitboard occ = (occupied() ^ from ^ squareBB(capSq)) | to;
+		return !(attackersTo(kingSq, occ) & pieces(~us) & ~squareBB(capSq));
+	}
+
+	if (m.from() == kingSq) { // Castling squares were checked by the generator, other king moves need a safe destination
+		return m.flag() == MoveFlag::Castling || !(attackersTo(m.to(), occupied() ^ from) & pieces(~us));
+	}
+
+	// In check, a non-king move must capture the only checker or block its line
+	if (checkersBB) {
+		if (checkersBB & (checkersBB - 1)) return false;
+		if (!((betweenBB(kingSq, lsb(checkersBB)) | checkersBB) & to)) return false;
+	}
+
+	// A pinned piece may only move along the line through its king
+	return !(pinnedBB & from) || (lineBB(kingSq, m.from()) & to);
+}
+
+// Castling rights kept when a piece moves from or to each square
+static const std::array<int, 64> castlingMask = [] {
+	std::array<int, 64> mask;
+	mask.fill(AllCastling);
+	mask[square(1, 1)] = AllCastling & ~WhiteQueenSide;
+	mask[square(8, 1)] = AllCastling & ~WhiteKingSide;
+	mask[square(5, 1)] = AllCastling & ~(WhiteKingSide | WhiteQueenSide);
+	mask[square(1, 8)] = AllCastling & ~BlackQueenSide;
+	mask[square(8, 8)] = AllCastling & ~BlackKingSide;
+	mask[square(5, 8)] = AllCastling & ~(BlackKingSide | BlackQueenSide);
+	return mask;
+}();
+
+// Rook origin and destination for a castling king move to kingTo
+static void castlingRookSquares(int kingTo, int& rookFrom, int& rookTo) {
+	bool kingSide = fileOf(kingTo) == 7;
+	rookFrom = square(kingSide ? 8 : 1, rankOf(kingTo));
+	rookTo = square(kingSide ? 6 : 4, rankOf(kingTo));
+}
+
+void Position::makeMove(const Move& m, UndoInfo& undo) {
+	undo.captured = NoPiece;
+	undo.castling = castling;
+	undo.epSquare = epSquare;
+	undo.halfmoveClock = halfmoveClock;
+	undo.key = key;
+	undo.checkers = checkersBB;
+	undo.pinned = pinnedBB;
+
+	Color us = side;
+	bool isPawn = typeOf(mailbox[m.from()]) == PieceType::Pawn;
+	int forward = us == White ? 8 : -8;
+
+	if (m.flag() == MoveFlag::Castling) {
+		int rookFrom, rookTo;
+		castlingRookSquares(m.to(), rookFrom, rookTo);
+		movePiece(m.from(), m.to());
+		movePiece(rookFrom, rookTo);
+	}
+	else {
+		int capSq = m.flag() == MoveFlag::EnPassant ? m.to() - forward : m.to(); // En passant captures behind the destination
+		if (mailbox[capSq] != NoPiece) {
+			undo.captured = mailbox[capSq];
+			removePiece(capSq);
+		}
+		movePiece(m.from(), m.to());
+		if (m.flag() == MoveFlag::Promotion) {
+			removePiece(m.to());
+			addPiece(m.to(), us, m.promotion());
+		}
+	}
+
+	halfmoveClock = (isPawn || undo.captured != NoPiece) ? 0 : halfmoveClock + 1;
+	setCastlingRights(castling & castlingMask[m.from()] & castlingMask[m.to()]);
+
+	// Only record an en passant square if an enemy pawn can actually capture onto it
+	int passed = m.from() + forward;
+	bool epPossible = isPawn && m.to() - m.from() == 2 * forward && (pawnAttacks(us, passed) & pieces(~us, PieceType::Pawn));
+	setEnPassantSquare(epPossible ? passed : -1);
+
+	if (us == Black) fullmoveNumber++;
+	side = ~us;
+	key ^= ZobristSide;
+	updateCheckInfo();
+}
+
+void Position::unmakeMove(const Move& m, const UndoInfo& undo) {
+	side = ~side;
+	Color us = side;
+	if (us == Black) fullmoveNumber--;
+
+	if (m.flag() == MoveFlag::Castling) {
+		int rookFrom, rookTo;
+		castlingRookSquares(m.to(), rookFrom, rookTo);
+		movePiece(rookTo, rookFrom);
+		movePiece(m.to(), m.from());
+	}
+	else {
+		if (m.flag() == MoveFlag::Promotion) {
+			removePiece(m.to());
+			addPiece(m.to(), us, PieceType::Pawn);
+		}
+		movePiece(m.to(), m.from());
+		if (undo.captured != NoPiece) {
+			int capSq = m.flag() == MoveFlag::EnPassant ? m.to() - (us == White ? 8 : -8) : m.to();
+			addPiece(capSq, colorOf(undo.captured), typeOf(undo.captured));
+		}
+	}
+
+	castling = undo.castling;
+	epSquare = undo.epSquare;
+	halfmoveClock = undo.halfmoveClock;
+	key = undo.key; // Restoring the saved key and check info is cheaper than recomputing them
+	checkersBB = undo.checkers;
+	pinnedBB = undo.pinned;
+}
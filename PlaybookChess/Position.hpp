@@ -0,0 +1,111 @@
+// Position.hpp
+// Position class
+// Bitboard and mailbox representation of the pieces on the board, plus side to move, castling, and en passant state
+
+#pragma once
+#include "Bitboard.hpp"
+#include "Move.hpp"
+#include <array>
+#include <string>
+
+// Castling right bits
+enum CastlingRight : int {
+	WhiteKingSide = 1, WhiteQueenSide = 2, BlackKingSide = 4, BlackQueenSide = 8,
+	NoCastling = 0, AllCastling = 15
+};
+
+// Standard starting position in Forsyth-Edwards Notation
+extern const char* const StartFen;
+
+// State that a move destroys, saved by makeMove so unmakeMove can restore it
+struct UndoInfo {
+	PieceCode captured = NoPiece;
+	int castling = NoCastling;
+	int epSquare = -1;
+	int halfmoveClock = 0;
+	std::uint64_t key = 0; // Zobrist key before the move
+	Bitboard checkers = 0; // Check info before the move
+	Bitboard pinned = 0;
+};
+
+class Position {
+private:
+	Bitboard colorBB[2] = {}; // Occupancy for each color
+	Bitboard typeBB[6] = {}; // Occupancy for each piece type, both colors
+	std::array<PieceCode, 64> mailbox; // Piece on each square, NoPiece if empty
+	Color side = White; // Side to move
+	int castling = NoCastling; // CastlingRight bits still available
+	int epSquare = -1; // Square a pawn can capture onto en passant, -1 if none
+	int halfmoveClock = 0; // Moves since the last capture or pawn move
+	int fullmoveNumber = 1;
+	std::uint64_t key = 0; // Zobrist key, updated incrementally by every change to the position
+	Bitboard checkersBB = 0; // Enemy pieces giving check to the side to move
+	Bitboard pinnedBB = 0; // Side to move's pieces that are the only blocker between their king and an enemy slider
+
+	template<Color Us, PieceType Pt>
+	bool isValidMoveFor(int from, int to) const; // isValidMove compiled for one piece, defined in Position.cpp
+
+public:
+	Position(); // Constructor, creates an empty board
+	void clear();
+	bool setFromFen(const std::string& fen); // Returns false and leaves an empty board if the FEN is malformed
+	std::string toFen() const;
+
+	void addPiece(int sq, Color c, PieceType t);
+	void removePiece(int sq);
+	void movePiece(int from, int to); // Destination must be empty
+
+	// Occupancy queries
+	Bitboard occupied() const { return colorBB[White] | colorBB[Black]; }
+	Bitboard pieces(Color c) const { return colorBB[c]; }
+	Bitboard pieces(PieceType t) const { return typeBB[static_cast<int>(t)]; }
+	Bitboard pieces(Color c, PieceType t) const { return colorBB[c] & typeBB[static_cast<int>(t)]; }
+	PieceCode pieceOn(int sq) const { return mailbox[sq]; }
+	bool isOccupied(int sq) const { return (occupied() & squareBB(sq)) != 0; }
+	bool isPathClear(int from, int to) const { return (betweenBB(from, to) & occupied()) == 0; }
+	int kingSquare(Color c) const; // Returns -1 if there is no king of that color
+
+	// Game state
+	Color sideToMove() const { return side; }
+	int castlingRights() const { return castling; }
+	int enPassantSquare() const { return epSquare; }
+	int halfmoves() const { return halfmoveClock; }
+	int fullmoves() const { return fullmoveNumber; }
+	std::uint64_t getKey() const { return key; }
+	std::uint64_t computeKey() const; // Full recomputation, used to verify the incremental key
+	void setSideToMove(Color c);
+	void setCastlingRights(int rights);
+	void setEnPassantSquare(int sq);
+	void setMoveCounters(int halfmove, int fullmove) { halfmoveClock = halfmove; fullmoveNumber = fullmove; }
+
+	// Move validation
+	bool isValidMove(int from, int to) const; // Checks piece movement rules for the piece on from, ignoring checks
+	Bitboard attackersTo(int sq, Bitboard occ) const; // Pieces of both colors attacking sq with the given occupancy
+	bool isSquareAttacked(int sq, Color by) const;
+	template<Color By>
+	bool isAttackedBy(int sq) const; // isSquareAttacked with the attacking color fixed at compile time
+	bool isInCheck(Color c) const; // Checks if the king of color c is attacked
+
+	// Check info for the side to move, kept up to date by makeMove, unmakeMove, and setFromFen.
+	// Code that builds a position with addPiece or removePiece must call updateCheckInfo afterwards.
+	Bitboard checkers() const { return checkersBB; }
+	Bitboard pinned() const { return pinnedBB; }
+	void updateCheckInfo();
+	bool isLegal(const Move& m) const; // Checks if a pseudo-legal move leaves the mover's king safe, without making it
+
+	// Make and unmake, the move must be at least pseudo-legal
+	void makeMove(const Move& m, UndoInfo& undo);
+	void unmakeMove(const Move& m, const UndoInfo& undo);
+};
+
+template<Color By>
+inline bool Position::isAttackedBy(int sq) const {
+	Bitboard occ = occupied();
+	Bitboard diagonal = pieces(By, PieceType::Bishop) | pieces(By, PieceType::Queen);
+	Bitboard straight = pieces(By, PieceType::Rook) | pieces(By, PieceType::Queen);
+	return ((pawnAttacks<~By>(sq) & pieces(By, PieceType::Pawn))
+		| (knightAttacks(sq) & pieces(By, PieceType::Knight))
+		| (kingAttacks(sq) & pieces(By, PieceType::King))
+		| (bishopAttacks(sq, occ) & diagonal)
+		| (rookAttacks(sq, occ) & straight)) != 0;
+}
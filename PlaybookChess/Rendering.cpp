@@ -3,33 +3,114 @@
 // Global constants
 
 #include "Rendering.hpp"
+#include "sprites.h"
+#include <array>
+#include <future>
 #include <iostream>
-#include <vector>
 
 const float squareSize = 80.f;
-std::map<std::string, sf::Texture> pieceTextures;
-
-bool loadPieceTextures() {
-    std::vector<std::pair<std::string, std::string>> paths = { // Matches piece name (key) to texture path
-        {"white_pawn",  "Sprites/white_pawn.png"},
-        {"white_rook",  "Sprites/white_rook.png"},
-        {"white_knight","Sprites/white_knight.png"},
-        {"white_bishop","Sprites/white_bishop.png"},
-        {"white_queen", "Sprites/white_queen.png"},
-        {"white_king",  "Sprites/white_king.png"},
-        {"black_pawn",  "Sprites/black_pawn.png"},
-        {"black_rook",  "Sprites/black_rook.png"},
-        {"black_knight","Sprites/black_knight.png"},
-        {"black_bishop","Sprites/black_bishop.png"},
-        {"black_queen", "Sprites/black_queen.png"},
-        {"black_king",  "Sprites/black_king.png"}
-    };
-
-    for (auto& [key, path] : paths) { // Checks if each texture was loaded correctly
-        if (!pieceTextures[key].loadFromFile(path)) {
-            std::cerr << "ERROR: Could not load " << path << std::endl;
+const float boardOffset = 64.f;
+sf::Texture pieceAtlas;
+
+static sf::Vector2u atlasCell; // Size of one sprite in the atlas
+
+bool packPieceAtlas(const std::string& spriteDir, sf::Image& atlas) {
+    static const char* colorNames[2] = { "white", "black" };
+    static const char* typeNames[6] = { "pawn", "knight", "bishop", "rook", "queen", "king" };
+
+    // PNG decoding is the slow part, so every sprite gets its own thread
+    std::array<sf::Image, 12> sprites;
+    std::array<std::future<bool>, 12> decoded;
+    for (int i = 0; i < 12; i++) {
+        std::string path = spriteDir + "/" + colorNames[i / 6] + "_" + typeNames[i % 6] + ".png";
+        decoded[i] = std::async(std::launch::async, [&sprites, i, path] { return sprites[i].loadFromFile(path); });
+    }
+
+    bool ok = true;
+    for (int i = 0; i < 12; i++) { // Checks if each texture was loaded correctly, waits for every thread before returning
+        if (!decoded[i].get()) {
+            std::cerr << "ERROR: Could not load " << spriteDir << "/" << colorNames[i / 6] << "_" << typeNames[i % 6] << ".png" << std::endl;
+            ok = false;
+        }
+    }
+    if (!ok) return false;
+
+    sf::Vector2u cell = sprites[0].getSize(); // Every sprite must match the first one
+    atlas.resize({ cell.x * 6, cell.y * 2 }, sf::Color::Transparent);
+    for (int i = 0; i < 12; i++) {
+        if (sprites[i].getSize().x != cell.x || sprites[i].getSize().y != cell.y) {
+            std::cerr << "ERROR: " << colorNames[i / 6] << "_" << typeNames[i % 6] << ".png does not match the size of the other sprites" << std::endl;
             return false;
         }
+        if (!atlas.copy(sprites[i], { cell.x * (i % 6), cell.y * (i / 6) })) {
+            std::cerr << "ERROR: Could not pack " << colorNames[i / 6] << "_" << typeNames[i % 6] << ".png into the piece atlas" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool loadPieceAtlasImage(sf::Image& atlas) {
+#ifdef PLAYBOOKCHESS_EMBED_ASSETS
+    atlas.resize({ embeddedAtlasWidth, embeddedAtlasHeight }, embeddedAtlasPixels); // Already decoded and packed at build time
+    return true;
+#else
+    return packPieceAtlas("Sprites", atlas);
+#endif
+}
+
+bool loadPieceTextures(const sf::Image& atlas) {
+    if (!pieceAtlas.loadFromImage(atlas)) {
+        std::cerr << "ERROR: Could not create the piece atlas texture" << std::endl;
+        return false;
     }
+    atlasCell = { atlas.getSize().x / 6, atlas.getSize().y / 2 };
+    pieceAtlas.setSmooth(true); // Sprites are scaled down to the square size
     return true;
+}
+
+bool loadFont(sf::Font& font) {
+#ifdef PLAYBOOKCHESS_EMBED_ASSETS
+    return font.openFromMemory(embeddedFont, embeddedFontSize); // The font reads from the array lazily, which lives as long as the program
+#else
+    return font.openFromFile("Typography Times Regular.ttf");
+#endif
+}
+
+sf::IntRect pieceAtlasRect(Color color, PieceType type) {
+    sf::Vector2i cell(static_cast<int>(atlasCell.x), static_cast<int>(atlasCell.y));
+    return sf::IntRect({ cell.x * static_cast<int>(type), cell.y * static_cast<int>(color) }, cell);
+}
+
+sf::FloatRect squareRect(int file, int rank) {
+    return sf::FloatRect({ (file - 1) * squareSize + boardOffset, (rank - 1) * squareSize + boardOffset }, { squareSize, squareSize });
+}
+
+void appendQuad(sf::VertexArray& vertices, sf::FloatRect rect, sf::Color color) {
+    sf::Vector2f topLeft = rect.position;
+    sf::Vector2f topRight(rect.position.x + rect.size.x, rect.position.y);
+    sf::Vector2f bottomLeft(rect.position.x, rect.position.y + rect.size.y);
+    sf::Vector2f bottomRight = rect.position + rect.size;
+
+    vertices.append({ topLeft, color });
+    vertices.append({ topRight, color });
+    vertices.append({ bottomLeft, color });
+    vertices.append({ bottomLeft, color });
+    vertices.append({ topRight, color });
+    vertices.append({ bottomRight, color });
+}
+
+void appendQuad(sf::VertexArray& vertices, sf::FloatRect rect, sf::IntRect texRect) {
+    size_t first = vertices.getVertexCount();
+    appendQuad(vertices, rect, sf::Color::White);
+
+    // Texture coordinates in the same corner order as the positions above
+    sf::Vector2f texTopLeft(texRect.position);
+    sf::Vector2f texBottomRight(texRect.position + texRect.size);
+    vertices[first + 0].texCoords = texTopLeft;
+    vertices[first + 1].texCoords = { texBottomRight.x, texTopLeft.y };
+    vertices[first + 2].texCoords = { texTopLeft.x, texBottomRight.y };
+    vertices[first + 3].texCoords = { texTopLeft.x, texBottomRight.y };
+    vertices[first + 4].texCoords = { texBottomRight.x, texTopLeft.y };
+    vertices[first + 5].texCoords = texBottomRight;
 }
\ No newline at end of file
@@ -1,18 +1,24 @@
 // Rendering.hpp
 // Texture mapping
-// PieceType enum
 // Global constants
 
 #pragma once
 #include <SFML/Graphics.hpp>
-#include <map>
 #include <string>
+#include "Types.hpp"
 
 extern const float squareSize;
-extern std::map<std::string, sf::Texture> pieceTextures; // Maps piece texture to the name of the piece for easier rendering
+extern const float boardOffset; // Pixel offset of the a1 corner from the window's top left, leaves room for the coordinates
+extern sf::Texture pieceAtlas; // All 12 piece sprites packed into one texture, so every piece can be drawn in one call
 
-enum class PieceType {
-	Pawn, Knight, Bishop, Rook, Queen, King
-};
+// Atlas layout: one row per color, one column per PieceType in enum order
+bool packPieceAtlas(const std::string& spriteDir, sf::Image& atlas); // Decodes the 12 sprite PNGs in parallel and packs them
+bool loadPieceAtlasImage(sf::Image& atlas); // Embedded atlas when built in, otherwise packPieceAtlas on Sprites/, needs no window
+bool loadPieceTextures(const sf::Image& atlas); // Uploads the atlas, returns error if the texture could not be created
+bool loadFont(sf::Font& font); // Embedded font when built in, otherwise the TTF in the working directory
+sf::IntRect pieceAtlasRect(Color color, PieceType type); // Area of the atlas holding a piece's sprite
 
-bool loadPieceTextures(); // Loads all textures, returns error if a texture could not be loaded
\ No newline at end of file
+// Quads are appended as two triangles, so any number of them can be drawn with a single draw call
+void appendQuad(sf::VertexArray& vertices, sf::FloatRect rect, sf::Color color);
+void appendQuad(sf::VertexArray& vertices, sf::FloatRect rect, sf::IntRect texRect);
+sf::FloatRect squareRect(int file, int rank); // Screen area of a board square
\ No newline at end of file
@@ -0,0 +1,124 @@
+// Rules.cpp
+// Handles rules class
+
+#include "Rules.hpp"
+#include "MoveGen.hpp"
+#include "Notation.hpp"
+#include <algorithm>
+#include <iostream>
+
+// Rules constructor
+Rules::Rules() {
+	reset();
+}
+
+bool Rules::reset(const std::string& fen) {
+	bool ok = position.setFromFen(fen);
+	keyHistory.clear();
+	keyHistory.reserve(ReservedPlies + 1);
+	keyHistory.push_back(position.getKey());
+	history.clear();
+	history.reserve(ReservedPlies);
+	ply = 0;
+	updateResult();
+	return ok;
+}
+
+bool Rules::isKingInCheck(bool whiteKing) const {
+	Color c = whiteKing ? White : Black;
+	if (position.kingSquare(c) == -1) std::cerr << "ERROR: King not found in King in Check function" << std::endl;
+
+	return position.isInCheck(c);
+}
+
+bool Rules::isCheckmate(bool whiteKing) const {
+	// Only the side to move can be checkmated
+	if (whiteToMove() != whiteKing) return false;
+
+	// Checkmate if the king is in check and updateResult found no legal move
+	return legalMoves.empty() && isKingInCheck(whiteKing);
+}
+
+bool Rules::isStalemate(bool whiteKing) const {
+	if (whiteToMove() != whiteKing) return false;
+	return legalMoves.empty() && !isKingInCheck(whiteKing);
+}
+
+bool Rules::isThreefoldRepetition() const {
+	// Only positions since the last capture or pawn move can repeat, and only with the same side to move
+	std::uint64_t key = position.getKey();
+	int last = static_cast<int>(keyHistory.size()) - 1;
+	int oldest = std::max(0, last - position.halfmoves());
+	int count = 1;
+	for (int i = last - 2; i >= oldest; i -= 2)
+		if (keyHistory[i] == key && ++count >= 3) return true;
+	return false;
+}
+
+void Rules::updateResult() {
+	// One generation answers both mate and stalemate and fills the destination cache for the front-end
+	generateLegalMoves(position, legalMoves);
+	legalTargets.fill(0);
+	for (const Move& m : legalMoves) legalTargets[m.from()] |= squareBB(m.to());
+
+	bool white = whiteToMove();
+	if (legalMoves.empty()) gameResult = isKingInCheck(white) ? (white ? GameResult::BlackWins : GameResult::WhiteWins) : GameResult::Stalemate;
+	else if (isThreefoldRepetition()) gameResult = GameResult::Repetition;
+	else gameResult = GameResult::Ongoing;
+}
+
+std::optional<Move> Rules::findMove(int fromFile, int fromRank, int toFile, int toRank) {
+	int from = square(fromFile, fromRank), to = square(toFile, toRank);
+	if (isGameOver() || !(legalTargets[from] & squareBB(to))) return std::nullopt; // Illegal clicks stop at the cache
+
+	for (const Move& m : legalMoves)
+		if (m.from() == from && m.to() == to && (m.flag() != MoveFlag::Promotion || m.promotion() == PieceType::Queen))
+			return m;
+	return std::nullopt;
+}
+
+MoveResult Rules::play(const Move& move, HistoryEntry& entry) {
+	MoveResult r;
+	r.move = move;
+	r.notation = moveToSan(position, move);
+	r.isCapture = position.pieceOn(move.to()) != NoPiece || move.flag() == MoveFlag::EnPassant;
+
+	entry.move = move;
+	position.makeMove(move, entry.undo);
+	keyHistory.push_back(position.getKey());
+	ply++;
+	r.givesCheck = position.isInCheck(position.sideToMove());
+	updateResult();
+	r.result = gameResult;
+	return r;
+}
+
+MoveResult Rules::applyMove(const Move& move) {
+	history.resize(ply); // A new move replaces whatever was taken back
+	history.emplace_back();
+	return play(move, history.back());
+}
+
+std::optional<Move> Rules::lastMove() const {
+	if (ply == 0) return std::nullopt;
+	return history[ply - 1].move;
+}
+
+std::optional<Move> Rules::undoMove() {
+	if (!canUndo()) return std::nullopt;
+	HistoryEntry& entry = history[--ply];
+	position.unmakeMove(entry.move, entry.undo);
+	keyHistory.pop_back();
+	updateResult();
+	return entry.move;
+}
+
+std::optional<MoveResult> Rules::redoMove() {
+	if (!canRedo()) return std::nullopt;
+	HistoryEntry& entry = history[ply];
+	return play(entry.move, entry);
+}
+
+void Rules::clearRedo() {
+	history.resize(ply);
+}
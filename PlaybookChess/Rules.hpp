@@ -0,0 +1,78 @@
+// Rules.hpp
+// Rules class
+// Headless game state: legality, check, checkmate, and move notation, with no window or textures
+
+#pragma once
+#include "Position.hpp"
+#include "Move.hpp"
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+enum class GameResult {
+	Ongoing, WhiteWins, BlackWins, Stalemate, Repetition
+};
+
+// Everything the front-end needs to report about a move that was just played
+struct MoveResult {
+	Move move;
+	std::string notation; // Standard algebraic notation, such as Nxf3+
+	bool isCapture = false;
+	bool givesCheck = false;
+	GameResult result = GameResult::Ongoing;
+};
+
+// A played move and the state it destroyed, enough to take it back without recomputing anything
+struct HistoryEntry {
+	Move move;
+	UndoInfo undo;
+};
+
+class Rules {
+private:
+	Position position;
+	GameResult gameResult = GameResult::Ongoing;
+	std::vector<std::uint64_t> keyHistory; // Zobrist key of every position reached, oldest first
+	std::vector<HistoryEntry> history; // Moves on the board, then moves taken back that can still be replayed
+	int ply = 0; // Moves on the board, entries from here on are the redo list
+	MoveList legalMoves; // Legal moves for the side to move, generated once per position
+	std::array<Bitboard, 64> legalTargets{}; // Destinations of legalMoves by origin square
+
+	void updateResult(); // Regenerates legalMoves and legalTargets, then recomputes gameResult
+	MoveResult play(const Move& move, HistoryEntry& entry); // Makes the move, saving its undo state into entry
+
+public:
+	static constexpr int ReservedPlies = 1024; // History capacity set aside up front, longer games grow it
+
+	Rules(); // Constructor, starts from the standard position
+	bool reset(const std::string& fen = StartFen); // Returns false if the FEN is malformed
+
+	const Position& getPosition() const { return position; }
+	bool whiteToMove() const { return position.sideToMove() == White; }
+	GameResult result() const { return gameResult; }
+	bool isGameOver() const { return gameResult != GameResult::Ongoing; }
+
+	bool isKingInCheck(bool whiteKing) const; // Checks if king is in check, takes bool for if the king is white
+	bool isCheckmate(bool whiteKing) const; // Checks for checkmate, only the side to move can be checkmated
+	bool isStalemate(bool whiteKing) const; // Checks for stalemate, only the side to move can be stalemated
+	bool isThreefoldRepetition() const; // Checks if the current position has occurred three times
+	std::uint64_t positionKey() const { return position.getKey(); }
+	const std::vector<std::uint64_t>& getKeyHistory() const { return keyHistory; } // For repetition checks during a search
+
+	// Legal destinations of the piece on a square, empty for the side not to move. A lookup, nothing is generated.
+	Bitboard legalDestinations(int file, int rank) const { return legalTargets[square(file, rank)]; }
+
+	// Finds the legal move between two squares for the side to move, promotions default to a queen
+	std::optional<Move> findMove(int fromFile, int fromRank, int toFile, int toRank);
+	MoveResult applyMove(const Move& move); // Plays a legal move and reports its notation and outcome, dropping any redo list
+
+	// Takeback and replay restore the saved state, so both cost one unmake or make and never allocate
+	int plyCount() const { return ply; }
+	bool canUndo() const { return ply > 0; }
+	bool canRedo() const { return ply < static_cast<int>(history.size()); }
+	std::optional<Move> lastMove() const; // Move that led to the current position, if any
+	std::optional<Move> undoMove(); // Takes back the last move, which stays available to redoMove
+	std::optional<MoveResult> redoMove(); // Replays the most recently taken back move
+	void clearRedo(); // Forgets the moves taken back
+};
@@ -0,0 +1,326 @@
+// Search.cpp
+// Principal variation search with quiescence, transposition table cutoffs, and MVV-LVA ordering
+// Helper threads run the same search and feed each other through the shared transposition table
+
+#include "Search.hpp"
+#include "Evaluate.hpp"
+#include "MoveGen.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+// Mate scores are stored relative to the node so they stay correct when reached through another path
+static int scoreToTT(int score, int ply) {
+	if (score >= MateScore - MaxPly) return score + ply;
+	if (score <= -MateScore + MaxPly) return score - ply;
+	return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+	if (score >= MateScore - MaxPly) return score - ply;
+	if (score <= -MateScore + MaxPly) return score + ply;
+	return score;
+}
+
+static bool isCapture(const Position& position, const Move& m) {
+	return position.pieceOn(m.to()) != NoPiece || m.flag() == MoveFlag::EnPassant;
+}
+
+int allocateMoveTime(long long timeLeftMs, long long incrementMs, long long movesToGo) {
+	long long share = timeLeftMs / (movesToGo > 0 ? movesToGo + 1 : 30) + incrementMs * 3 / 4;
+	return static_cast<int>(std::max(1LL, std::min(share, timeLeftMs / 2)));
+}
+
+// Search constructor
+Search::Search(TranspositionTable& table, int threads) : tt(table) {
+	setThreads(threads);
+}
+
+void Search::setThreads(int threads) {
+	workers.clear();
+	for (int i = 0; i < std::max(1, threads); i++) {
+		workers.push_back(std::make_unique<Worker>());
+		workers.back()->id = i;
+	}
+}
+
+std::uint64_t Search::totalNodes() const {
+	std::uint64_t total = 0;
+	for (const auto& w : workers) total += w->nodes.load(std::memory_order_relaxed);
+	return total;
+}
+
+// Counts a node, only the owning thread writes its counter
+static void addNode(std::atomic<std::uint64_t>& nodes) {
+	nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+double Search::elapsedSeconds() const {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool Search::timeUp(Worker& w) {
+	if (stopRequested.load(std::memory_order_relaxed)) return true;
+	if (w.id != 0 || limits.infinite) return false; // Only the main thread enforces limits
+	if (w.result.depth == 0) return false; // Limits apply once the first iteration has produced a move
+	std::uint64_t ownNodes = w.nodes.load(std::memory_order_relaxed);
+	if (limits.nodes && ownNodes >= limits.nodes) { // The main thread's own count never exceeds the total, so small budgets end on time
+		stopRequested.store(true, std::memory_order_relaxed);
+		return true;
+	}
+	if ((ownNodes & 2047) != 0) return false; // Reading the clock is slower than searching a node
+
+	if ((limits.nodes && totalNodes() >= limits.nodes) || (limits.movetimeMs && elapsedSeconds() * 1000 >= limits.movetimeMs))
+		stopRequested.store(true, std::memory_order_relaxed);
+	return stopRequested.load(std::memory_order_relaxed);
+}
+
+bool Search::isRepetition(const Worker& w) const {
+	// Any earlier occurrence within the reversible moves is scored as a draw
+	int last = static_cast<int>(w.keys.size()) - 1;
+	int oldest = std::max(0, last - w.position.halfmoves());
+	for (int i = last - 2; i >= oldest; i -= 2)
+		if (w.keys[i] == w.keys[last]) return true;
+	return false;
+}
+
+void Search::scoreMoves(const Worker& w, const MoveList& moves, int* scores, const Move& ttMove, int ply) const {
+	const Position& position = w.position;
+	for (int i = 0; i < moves.size(); i++) {
+		const Move& m = moves[i];
+		if (m == ttMove) {
+			scores[i] = 2000000;
+		}
+		else if (isCapture(position, m) || m.flag() == MoveFlag::Promotion) {
+			// Most valuable victim, least valuable attacker
+			int victim = m.flag() == MoveFlag::EnPassant ? 0 : (position.pieceOn(m.to()) == NoPiece ? 0 : static_cast<int>(typeOf(position.pieceOn(m.to()))));
+			int attacker = static_cast<int>(typeOf(position.pieceOn(m.from())));
+			scores[i] = 1000000 + PieceValues[victim] * 10 - attacker + (m.flag() == MoveFlag::Promotion ? PieceValues[static_cast<int>(m.promotion())] : 0);
+		}
+		else if (m == w.killers[ply][0]) {
+			scores[i] = 900000;
+		}
+		else if (m == w.killers[ply][1]) {
+			scores[i] = 800000;
+		}
+		else {
+			scores[i] = w.history[m.from()][m.to()];
+		}
+	}
+}
+
+// Moves the best scoring remaining move to index i
+static void pickMove(MoveList& moves, int* scores, int i) {
+	int best = i;
+	for (int j = i + 1; j < moves.size(); j++)
+		if (scores[j] > scores[best]) best = j;
+	std::swap(moves[i], moves[best]);
+	std::swap(scores[i], scores[best]);
+}
+
+int Search::quiescence(Worker& w, int alpha, int beta, int ply) {
+	Position& position = w.position;
+	w.pvLength[ply] = 0;
+	if (timeUp(w)) return 0;
+
+	int standPat = evaluate(position);
+	if (ply >= MaxPly - 1) return standPat;
+	if (standPat >= beta) return standPat;
+	if (standPat > alpha) alpha = standPat;
+
+	MoveList moves;
+	generateLegalCaptures(position, moves);
+	int scores[256];
+	scoreMoves(w, moves, scores, Move{}, ply);
+
+	int best = standPat;
+	for (int i = 0; i < moves.size(); i++) {
+		pickMove(moves, scores, i);
+		const Move& m = moves[i];
+
+		UndoInfo undo;
+		position.makeMove(m, undo);
+		addNode(w.nodes);
+		int score = -quiescence(w, -beta, -alpha, ply + 1);
+		position.unmakeMove(m, undo);
+
+		if (stopRequested.load(std::memory_order_relaxed)) return 0;
+		if (score > best) {
+			best = score;
+			if (score > alpha) {
+				alpha = score;
+				if (score >= beta) break;
+			}
+		}
+	}
+	return best;
+}
+
+int Search::negamax(Worker& w, int depth, int alpha, int beta, int ply, bool pvNode) {
+	Position& position = w.position;
+	w.pvLength[ply] = 0;
+	if (timeUp(w)) return 0;
+
+	if (ply > 0 && (position.halfmoves() >= 100 || isRepetition(w))) return 0;
+
+	bool inCheck = position.isInCheck(position.sideToMove());
+	if (inCheck) depth++; // Check extension
+	if (depth <= 0) return quiescence(w, alpha, beta, ply);
+	if (ply >= MaxPly - 1) return evaluate(position);
+
+	// Transposition table lookup, cutoffs are only taken outside the principal variation
+	TTData entry;
+	Move ttMove;
+	std::uint64_t key = position.getKey();
+	if (tt.probe(key, entry)) {
+		ttMove = entry.move;
+		int ttScore = scoreFromTT(entry.score, ply);
+		if (!pvNode && entry.depth >= depth) {
+			if (entry.bound == Bound::Exact
+				|| (entry.bound == Bound::Lower && ttScore >= beta)
+				|| (entry.bound == Bound::Upper && ttScore <= alpha))
+				return ttScore;
+		}
+	}
+
+	MoveList moves;
+	generateLegalMoves(position, moves);
+	if (moves.empty()) return inCheck ? -MateScore + ply : 0;
+
+	int scores[256];
+	scoreMoves(w, moves, scores, ttMove, ply);
+
+	int originalAlpha = alpha;
+	int best = -InfiniteScore;
+	Move bestMove = moves[0];
+
+	for (int i = 0; i < moves.size(); i++) {
+		pickMove(moves, scores, i);
+		const Move m = moves[i];
+		bool quiet = !isCapture(position, m) && m.flag() != MoveFlag::Promotion;
+
+		UndoInfo undo;
+		position.makeMove(m, undo);
+		w.keys.push_back(position.getKey());
+		addNode(w.nodes);
+
+		// The first move gets a full window, later moves are expected to fail low and get a null window first
+		int score;
+		if (i == 0) {
+			score = -negamax(w, depth - 1, -beta, -alpha, ply + 1, pvNode);
+		}
+		else {
+			score = -negamax(w, depth - 1, -alpha - 1, -alpha, ply + 1, false);
+			if (score > alpha && score < beta)
+				score = -negamax(w, depth - 1, -beta, -alpha, ply + 1, true);
+		}
+
+		w.keys.pop_back();
+		position.unmakeMove(m, undo);
+		if (stopRequested.load(std::memory_order_relaxed)) return 0;
+
+		if (score > best) {
+			best = score;
+			bestMove = m;
+			if (score > alpha) {
+				alpha = score;
+
+				// Copy the child's variation behind this move
+				w.pvTable[ply][0] = m;
+				std::memcpy(&w.pvTable[ply][1], w.pvTable[ply + 1], w.pvLength[ply + 1] * sizeof(Move));
+				w.pvLength[ply] = w.pvLength[ply + 1] + 1;
+
+				if (score >= beta) {
+					if (quiet) {
+						if (w.killers[ply][0] != m) {
+							w.killers[ply][1] = w.killers[ply][0];
+							w.killers[ply][0] = m;
+						}
+						w.history[m.from()][m.to()] += depth * depth;
+						if (w.history[m.from()][m.to()] > 700000) // Keep history below the killer scores
+							for (auto& row : w.history)
+								for (int& h : row) h /= 2;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	TTData store;
+	store.move = bestMove;
+	store.score = scoreToTT(best, ply);
+	store.depth = depth;
+	store.bound = best >= beta ? Bound::Lower : (best > originalAlpha ? Bound::Exact : Bound::Upper);
+	tt.store(key, store);
+	return best;
+}
+
+void Search::iterativeDeepening(Worker& w) {
+	SearchResult& result = w.result;
+	MoveList rootMoves;
+	generateLegalMoves(w.position, rootMoves);
+	if (rootMoves.empty()) return;
+
+	result.hasMove = true;
+	result.bestMove = rootMoves[0]; // Fallback if even depth 1 is interrupted
+
+	// Odd helpers start one ply deeper so the threads spread over different depths
+	int firstDepth = 1 + (w.id % 2);
+	int maxDepth = std::min(limits.depth, MaxPly - 1);
+	for (int depth = firstDepth; depth <= maxDepth; depth++) {
+		int score = negamax(w, depth, -InfiniteScore, InfiniteScore, 0, true);
+		if (stopRequested.load(std::memory_order_relaxed) && depth > firstDepth) break; // Interrupted iterations are discarded
+
+		result.depth = depth;
+		result.score = score;
+		if (w.pvLength[0] > 0) {
+			result.bestMove = w.pvTable[0][0];
+			result.pv.assign(w.pvTable[0], w.pvTable[0] + w.pvLength[0]);
+		}
+		if (w.id != 0) continue; // Helpers keep searching until the main thread stops them
+
+		result.nodes = totalNodes();
+		result.seconds = elapsedSeconds();
+		if (reportIteration && *reportIteration) (*reportIteration)(result);
+
+		if (stopRequested.load(std::memory_order_relaxed)) break;
+		if (score >= MateScore - depth || score <= -MateScore + depth) break; // Forced mate found, deeper searches cannot improve it
+		if (!limits.infinite && limits.movetimeMs && elapsedSeconds() * 1000 * 2 >= limits.movetimeMs) break; // Next depth would not finish in time
+	}
+}
+
+SearchResult Search::think(const Position& root, const SearchLimits& searchLimits,
+	const std::vector<std::uint64_t>& history, const std::function<void(const SearchResult&)>& onIteration) {
+	startTime = std::chrono::steady_clock::now();
+	limits = searchLimits;
+	reportIteration = &onIteration;
+	stopRequested.store(false, std::memory_order_relaxed);
+	tt.newSearch();
+
+	for (auto& w : workers) {
+		w->position = root;
+		w->keys = history;
+		if (w->keys.empty() || w->keys.back() != root.getKey()) w->keys.push_back(root.getKey());
+		w->keys.reserve(w->keys.size() + MaxPly);
+		w->nodes.store(0, std::memory_order_relaxed);
+		w->result = SearchResult();
+		std::memset(w->killers, 0, sizeof(w->killers));
+		std::memset(w->history, 0, sizeof(w->history));
+	}
+
+	// Helpers run on their own threads, the main search runs on the calling thread
+	std::vector<std::thread> helpers;
+	for (std::size_t i = 1; i < workers.size(); i++)
+		helpers.emplace_back([this, i] { iterativeDeepening(*workers[i]); });
+
+	iterativeDeepening(*workers[0]);
+	stopRequested.store(true, std::memory_order_relaxed); // Main thread finished, helpers stop too
+	for (auto& t : helpers) t.join();
+
+	SearchResult result = workers[0]->result;
+	result.nodes = totalNodes();
+	result.seconds = elapsedSeconds();
+	reportIteration = nullptr;
+	return result;
+}
@@ -0,0 +1,88 @@
+// Search.hpp
+// Search class
+// Iterative-deepening alpha-beta search with a time or node budget
+// Runs on one or more threads that share the transposition table (Lazy SMP)
+
+#pragma once
+#include "Position.hpp"
+#include "Move.hpp"
+#include "TranspositionTable.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+constexpr int MaxPly = 128;
+constexpr int MateScore = 30000; // Mate in n plies scores MateScore - n
+constexpr int InfiniteScore = 32000;
+
+struct SearchLimits {
+	int depth = MaxPly - 1; // Deepest iteration to start
+	int movetimeMs = 0; // Time budget for the move, 0 for none
+	std::uint64_t nodes = 0; // Node budget, 0 for none
+	bool infinite = false; // Only stop() ends the search
+};
+
+// Clock mode: an even share of the remaining time plus most of the increment, never more than half the clock
+int allocateMoveTime(long long timeLeftMs, long long incrementMs, long long movesToGo = 0);
+
+// Reported after every completed iteration, and returned when the search ends
+struct SearchResult {
+	Move bestMove;
+	bool hasMove = false; // False if the root has no legal moves
+	int score = 0; // Centipawns from the side to move's point of view
+	int depth = 0; // Last completed iteration
+	std::uint64_t nodes = 0;
+	double seconds = 0;
+	std::vector<Move> pv; // Principal variation, starting with bestMove
+};
+
+class Search {
+private:
+	// Everything one search thread owns. Threads only share the transposition table and the stop flag.
+	struct Worker {
+		int id = 0; // 0 is the main thread, which checks limits and reports results
+		Position position;
+		std::vector<std::uint64_t> keys; // Keys of the game history followed by the current search path
+		std::atomic<std::uint64_t> nodes{ 0 }; // Written only by the owning thread, read by the main thread for totals
+		Move killers[MaxPly][2]; // Quiet moves that caused a beta cutoff at each ply
+		int history[64][64]; // Quiet move success by from and to square
+		Move pvTable[MaxPly][MaxPly];
+		int pvLength[MaxPly];
+		SearchResult result; // Last completed iteration
+	};
+
+	TranspositionTable& tt; // Shared table, owned by the caller
+	std::atomic<bool> stopRequested{ false };
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	// State for the current search
+	SearchLimits limits;
+	std::chrono::steady_clock::time_point startTime;
+	const std::function<void(const SearchResult&)>* reportIteration = nullptr;
+
+	int negamax(Worker& w, int depth, int alpha, int beta, int ply, bool pvNode);
+	int quiescence(Worker& w, int alpha, int beta, int ply);
+	bool isRepetition(const Worker& w) const;
+	bool timeUp(Worker& w); // Main thread checks limits every few thousand nodes and sets stopRequested
+	void scoreMoves(const Worker& w, const MoveList& moves, int* scores, const Move& ttMove, int ply) const;
+	void iterativeDeepening(Worker& w); // Body of each search thread
+	std::uint64_t totalNodes() const;
+
+public:
+	explicit Search(TranspositionTable& table, int threads = 1); // Constructor, takes the shared transposition table
+
+	void setThreads(int threads); // Number of threads used by the next search, at least 1
+	int threadCount() const { return static_cast<int>(workers.size()); }
+
+	// Searches the root position. history holds the keys of earlier game positions for repetition detection,
+	// onIteration is called from the calling thread after each depth the main thread completes.
+	SearchResult think(const Position& root, const SearchLimits& searchLimits,
+		const std::vector<std::uint64_t>& history = {},
+		const std::function<void(const SearchResult&)>& onIteration = nullptr);
+
+	void stop() { stopRequested.store(true, std::memory_order_relaxed); } // Safe to call from another thread
+	double elapsedSeconds() const;
+};
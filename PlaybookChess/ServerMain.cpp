@@ -0,0 +1,29 @@
+// ServerMain.cpp
+// Headless multi-game server, windows connect to it with --connect
+// Usage: server [--port n] [--workers n] [--max-connections n] [--max-games n] [--report seconds]
+
+#include "GameServer.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+	ServerOptions options;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--port") options.port = static_cast<unsigned short>(std::atoi(argv[i + 1]));
+		else if (arg == "--workers") options.workers = std::atoi(argv[i + 1]);
+		else if (arg == "--max-connections") options.maxConnections = std::atoi(argv[i + 1]);
+		else if (arg == "--max-games") options.maxGamesPerConnection = std::atoi(argv[i + 1]);
+		else if (arg == "--report") options.reportSeconds = std::atoi(argv[i + 1]);
+	}
+
+	GameServer server(options);
+	if (!server.start()) {
+		std::cerr << "ERROR: Could not listen on port " << options.port << std::endl;
+		return 1;
+	}
+	std::cout << "Listening on port " << server.getPort() << " with " << options.workers << " workers" << std::endl;
+	server.run(&std::cout);
+	return 0;
+}
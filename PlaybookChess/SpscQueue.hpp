@@ -0,0 +1,40 @@
+// SpscQueue.hpp
+// SpscQueue class
+// Bounded single-producer single-consumer ring buffer, lock free
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+// One thread pushes and one thread pops. Each index is written by only one side, so a release store
+// publishing the slot and an acquire load reading it are all the synchronization needed.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+	T slots[Capacity];
+	alignas(64) std::atomic<std::size_t> head{ 0 }; // Next slot to pop, written by the consumer
+	alignas(64) std::atomic<std::size_t> tail{ 0 }; // Next slot to push, written by the producer
+
+public:
+	bool push(T value) { // Producer only, returns false if the queue is full
+		std::size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+		slots[t & (Capacity - 1)] = std::move(value);
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	std::optional<T> pop() { // Consumer only, returns nullopt if the queue is empty
+		std::size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) return std::nullopt;
+		T value = std::move(slots[h & (Capacity - 1)]);
+		head.store(h + 1, std::memory_order_release);
+		return value;
+	}
+
+	bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,690 @@
+// Tablebase.cpp
+// Position indexing, retrograde generation, block compression, and probing
+// Tablebases class functions
+
+#include "Tablebase.hpp"
+#include "Bitboard.hpp"
+#include "MoveGen.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <thread>
+
+namespace {
+
+// Stored values: 0 is a draw (or not resolved yet while generating), 1 is a position that cannot arise,
+// anything else is plies to mate + 2. Even plies are losses for the side to move, odd plies are wins.
+constexpr std::uint8_t TbDraw = 0;
+constexpr std::uint8_t TbInvalid = 1;
+constexpr int TbMaxPlies = 253;
+
+constexpr std::uint32_t TbBlockSize = 1024; // Values per compressed block, a probe decodes at most one block
+constexpr std::uint32_t TbVersion = 1;
+
+// File header, followed by one 64-bit offset per block plus the end, then the blocks
+struct TbHeader {
+	char magic[4];
+	std::uint32_t version;
+	char name[12];
+	std::uint32_t blockSize;
+	std::uint64_t entries;
+	std::uint64_t blocksPerSide;
+};
+
+const PieceType NameOrder[6] = { PieceType::King, PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight, PieceType::Pawn };
+const char TypeLetters[] = "PNBRQK"; // Indexed by PieceType
+
+int strength(PieceType type) {
+	static const int values[6] = { 1, 3, 3, 5, 9, 0 };
+	return values[static_cast<int>(type)];
+}
+
+TbResult fromValue(std::uint8_t value) {
+	TbResult result;
+	if (value < 2) return result;
+	result.plies = value - 2;
+	result.outcome = result.plies % 2 ? TbOutcome::Win : TbOutcome::Loss;
+	return result;
+}
+
+std::uint8_t toValue(const TbResult& result) {
+	return result.outcome == TbOutcome::Draw ? TbDraw : static_cast<std::uint8_t>(result.plies + 2);
+}
+
+// Squares the white king may use after symmetry: the a1-d1-d4 triangle without pawns, files a-d with pawns
+struct KingSlots {
+	std::array<int, 64> slotOf{};
+	std::array<int, 32> squareOf{};
+	int count = 0;
+};
+
+KingSlots makeSlots(bool pawns) {
+	KingSlots slots;
+	slots.slotOf.fill(-1);
+	for (int sq = 0; sq < 64; sq++) {
+		int file = sq & 7, rank = sq >> 3;
+		bool allowed = pawns ? file <= 3 : file <= 3 && rank <= 3 && rank <= file;
+		if (!allowed) continue;
+		slots.slotOf[sq] = slots.count;
+		slots.squareOf[slots.count++] = sq;
+	}
+	return slots;
+}
+
+const KingSlots PawnlessSlots = makeSlots(false);
+const KingSlots PawnSlots = makeSlots(true);
+
+const KingSlots& slotsFor(const TbMaterial& m) { return m.hasPawns ? PawnSlots : PawnlessSlots; }
+
+// Index of a position given its squares in table order. The board is mirrored so the white king lands in its
+// slot region. Pawns only allow a left-right mirror.
+std::uint64_t encode(const TbMaterial& m, const int* squares) {
+	int wk = squares[0];
+	bool flipFile = (wk & 7) > 3;
+	bool flipRank = !m.hasPawns && (wk >> 3) > 3;
+	int mirrored[TbMaxPieces];
+	for (int i = 0; i < m.count; i++) mirrored[i] = squares[i] ^ (flipFile ? 7 : 0) ^ (flipRank ? 56 : 0);
+
+	// With the king on the a1-h8 diagonal, the first piece off the diagonal decides, so both mirror images share an index
+	bool transpose = false;
+	for (int i = 0; i < m.count && !m.hasPawns; i++) {
+		int file = mirrored[i] & 7, rank = mirrored[i] >> 3;
+		if (file == rank) continue;
+		transpose = rank > file;
+		break;
+	}
+
+	std::uint64_t index = 0;
+	for (int i = 0; i < m.count; i++) {
+		int sq = transpose ? ((mirrored[i] & 7) << 3) | (mirrored[i] >> 3) : mirrored[i];
+		index = i == 0 ? static_cast<std::uint64_t>(slotsFor(m).slotOf[sq]) : index * 64 + static_cast<std::uint64_t>(sq);
+	}
+	return index;
+}
+
+void decode(const TbMaterial& m, std::uint64_t index, int* squares) {
+	for (int i = m.count - 1; i > 0; i--) {
+		squares[i] = static_cast<int>(index & 63);
+		index >>= 6;
+	}
+	squares[0] = slotsFor(m).squareOf[index];
+}
+
+// Squares of a position's pieces in table order. flipped swaps the colors and mirrors the ranks.
+void squaresOf(const TbMaterial& m, const Position& position, bool flipped, int* squares) {
+	Bitboard remaining[2][6];
+	for (Color c : { White, Black })
+		for (int t = 0; t < 6; t++)
+			remaining[c][t] = position.pieces(c, static_cast<PieceType>(t));
+
+	for (int i = 0; i < m.count; i++) {
+		Color c = flipped ? ~m.colors[i] : m.colors[i];
+		int sq = popLsb(remaining[c][static_cast<int>(m.types[i])]);
+		squares[i] = flipped ? sq ^ 56 : sq;
+	}
+}
+
+// Builds the position, false if it cannot arise in a game: two pieces on one square,
+// a pawn on the first or last rank, or the side that just moved left in check
+bool setUp(const TbMaterial& m, const int* squares, Color side, Position& position) {
+	Bitboard used = 0;
+	for (int i = 0; i < m.count; i++) {
+		if (used & squareBB(squares[i])) return false;
+		used |= squareBB(squares[i]);
+		if (m.types[i] == PieceType::Pawn && (rankOf(squares[i]) == 1 || rankOf(squares[i]) == 8)) return false;
+	}
+
+	position.clear();
+	for (int i = 0; i < m.count; i++) position.addPiece(squares[i], m.colors[i], m.types[i]);
+	position.setSideToMove(side); // Also updates the check info
+	return !position.isInCheck(~side);
+}
+
+bool isConversion(const Position& position, const Move& move) {
+	return move.flag() == MoveFlag::Promotion || move.flag() == MoveFlag::EnPassant || position.pieceOn(move.to()) != NoPiece;
+}
+
+// Splits [0, total) into small chunks handed out to threads threads
+void parallelFor(std::uint64_t total, int threads, const std::function<void(std::uint64_t, std::uint64_t, int)>& body) {
+	constexpr std::uint64_t ChunkSize = 4096;
+	std::atomic<std::uint64_t> next{ 0 };
+	auto work = [&](int thread) {
+		for (std::uint64_t begin = next.fetch_add(ChunkSize); begin < total; begin = next.fetch_add(ChunkSize))
+			body(begin, std::min(total, begin + ChunkSize), thread);
+	};
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads; t++) pool.emplace_back(work, t);
+	work(0);
+	for (auto& t : pool) t.join();
+}
+
+// Block: a type byte, then either the raw values (0) or (run length - 1, value) pairs (1)
+void compressBlock(const std::uint8_t* values, std::size_t count, std::vector<std::uint8_t>& out) {
+	std::vector<std::uint8_t> runs;
+	for (std::size_t i = 0; i < count;) {
+		std::size_t run = 1;
+		while (i + run < count && run < 256 && values[i + run] == values[i]) run++;
+		runs.push_back(static_cast<std::uint8_t>(run - 1));
+		runs.push_back(values[i]);
+		i += run;
+	}
+	if (runs.size() < count) {
+		out.push_back(1);
+		out.insert(out.end(), runs.begin(), runs.end());
+	}
+	else {
+		out.push_back(0);
+		out.insert(out.end(), values, values + count);
+	}
+}
+
+// Retrograde analysis of one table. Positions are keyed side * entries + index, which is also their slot in values.
+// Level n resolves every position whose distance to mate is n plies. A position can only reach level n through
+// a child resolved at level n - 1, so each level only re-examines the predecessors of the previous level, plus
+// positions whose captures or promotions lead into smaller tables with the right distance.
+class Generator {
+private:
+	const TbMaterial& m;
+	const Tablebases& smaller; // Tables for captures and promotions
+	int threads;
+	std::uint64_t entries;
+	std::vector<std::vector<std::uint64_t>> buckets; // Keys to re-examine at each level because of a conversion
+
+	std::uint64_t keyOf(Color side, std::uint64_t index) const { return (side == White ? 0 : entries) + index; }
+
+	// Value of the position after move, from the opponent's point of view
+	std::uint8_t childValue(Position& position, const Move& move) const {
+		bool conversion = isConversion(position, move);
+		UndoInfo undo;
+		position.makeMove(move, undo);
+		std::uint8_t value;
+		if (conversion) {
+			std::optional<TbResult> result = smaller.probe(position);
+			value = result ? toValue(*result) : TbDraw; // Only bare kings have no table
+		}
+		else {
+			int squares[TbMaxPieces];
+			squaresOf(m, position, false, squares);
+			value = values[keyOf(position.sideToMove(), encode(m, squares))];
+		}
+		position.unmakeMove(move, undo);
+		return value;
+	}
+
+	void initialize(std::vector<std::uint64_t>& mated);
+	void addPredecessors(std::uint64_t key, std::vector<std::uint64_t>& out) const;
+	bool resolves(std::uint64_t key, int level) const;
+
+public:
+	std::vector<std::uint8_t> values;
+
+	Generator(const TbMaterial& material, const Tablebases& smallerTables, int threadCount)
+		: m(material), smaller(smallerTables), threads(std::max(1, threadCount)), entries(material.entries()),
+		buckets(TbMaxPlies + 2), values(2 * entries, TbDraw) {}
+
+	bool run(std::ostream* log);
+};
+
+void Generator::initialize(std::vector<std::uint64_t>& mated) {
+	std::vector<std::vector<std::uint64_t>> threadMated(threads);
+	std::vector<std::vector<std::vector<std::uint64_t>>> threadBuckets(threads, std::vector<std::vector<std::uint64_t>>(TbMaxPlies + 2));
+
+	parallelFor(2 * entries, threads, [&](std::uint64_t begin, std::uint64_t end, int thread) {
+		Position position;
+		MoveList moves;
+		int squares[TbMaxPieces];
+		for (std::uint64_t key = begin; key < end; key++) {
+			Color side = key < entries ? White : Black;
+			decode(m, key % entries, squares);
+			if (encode(m, squares) != key % entries || !setUp(m, squares, side, position)) { // Unused mirror images too
+				values[key] = TbInvalid;
+				continue;
+			}
+
+			generateLegalMoves(position, moves);
+			if (moves.empty()) {
+				if (position.isInCheck(side)) { // Checkmated, stalemates stay drawn
+					values[key] = 2;
+					threadMated[thread].push_back(key);
+				}
+				continue;
+			}
+
+			// Captures and promotions are already known, so they decide the level to look at this position again
+			int conversions = 0, minLoss = -1, maxWin = -1;
+			bool allWins = true;
+			for (const Move& move : moves) {
+				if (!isConversion(position, move)) continue;
+				conversions++;
+				TbResult child = fromValue(childValue(position, move));
+				if (child.outcome == TbOutcome::Loss && (minLoss == -1 || child.plies < minLoss)) minLoss = child.plies;
+				if (child.outcome == TbOutcome::Win) maxWin = std::max(maxWin, child.plies);
+				else allWins = false;
+			}
+			if (minLoss != -1) threadBuckets[thread][minLoss + 1].push_back(key);
+			else if (conversions > 0 && allWins && maxWin + 1 <= TbMaxPlies) threadBuckets[thread][maxWin + 1].push_back(key);
+		}
+	});
+
+	for (int t = 0; t < threads; t++) {
+		mated.insert(mated.end(), threadMated[t].begin(), threadMated[t].end());
+		for (int level = 0; level <= TbMaxPlies; level++)
+			buckets[level].insert(buckets[level].end(), threadBuckets[t][level].begin(), threadBuckets[t][level].end());
+	}
+}
+
+// Positions one quiet move earlier: a piece of the side that just moved is stepped back to an empty square
+void Generator::addPredecessors(std::uint64_t key, std::vector<std::uint64_t>& out) const {
+	Color side = key < entries ? White : Black;
+	Color mover = ~side;
+	int squares[TbMaxPieces];
+	decode(m, key % entries, squares);
+
+	Bitboard occupied = 0;
+	for (int i = 0; i < m.count; i++) occupied |= squareBB(squares[i]);
+
+	for (int i = 0; i < m.count; i++) {
+		if (m.colors[i] != mover) continue;
+		int sq = squares[i];
+		Bitboard targets = 0;
+		switch (m.types[i]) {
+		case PieceType::King:	targets = kingAttacks(sq); break;
+		case PieceType::Knight:	targets = knightAttacks(sq); break;
+		case PieceType::Bishop:	targets = bishopAttacks(sq, occupied); break;
+		case PieceType::Rook:	targets = rookAttacks(sq, occupied); break;
+		case PieceType::Queen:	targets = queenAttacks(sq, occupied); break;
+		case PieceType::Pawn: {
+			int back = mover == White ? -8 : 8;
+			int relativeRank = mover == White ? rankOf(sq) : 9 - rankOf(sq);
+			if (relativeRank >= 3 && !(occupied & squareBB(sq + back))) {
+				targets |= squareBB(sq + back);
+				if (relativeRank == 4 && !(occupied & squareBB(sq + 2 * back))) targets |= squareBB(sq + 2 * back);
+			}
+			break;
+		}
+		}
+		targets &= ~occupied;
+
+		while (targets) {
+			int previous[TbMaxPieces];
+			std::copy(squares, squares + m.count, previous);
+			previous[i] = popLsb(targets);
+			out.push_back(keyOf(mover, encode(m, previous)));
+		}
+	}
+}
+
+// Odd levels are wins through a child lost at level - 1, even levels are losses where every child is won
+bool Generator::resolves(std::uint64_t key, int level) const {
+	if (values[key] != TbDraw) return false;
+	Color side = key < entries ? White : Black;
+	int squares[TbMaxPieces];
+	decode(m, key % entries, squares);
+	Position position;
+	setUp(m, squares, side, position);
+
+	MoveList moves;
+	generateLegalMoves(position, moves);
+	if (moves.empty()) return false;
+
+	int longestWin = -1;
+	for (const Move& move : moves) {
+		TbResult child = fromValue(childValue(position, move));
+		if (level % 2 == 1) {
+			if (child.outcome == TbOutcome::Loss && child.plies == level - 1) return true;
+		}
+		else {
+			if (child.outcome != TbOutcome::Win) return false;
+			longestWin = std::max(longestWin, child.plies);
+		}
+	}
+	return level % 2 == 0 && longestWin == level - 1;
+}
+
+bool Generator::run(std::ostream* log) {
+	std::vector<std::uint64_t> resolved;
+	initialize(resolved);
+
+	for (int level = 1; level <= TbMaxPlies + 1; level++) {
+		bool pending = !resolved.empty();
+		for (int later = level; later <= TbMaxPlies && !pending; later++) pending = !buckets[later].empty();
+		if (!pending) return true;
+		if (level > TbMaxPlies) {
+			if (log) *log << "ERROR: " << m.name() << " has mates longer than " << TbMaxPlies << " plies" << std::endl;
+			return false;
+		}
+
+		// Candidates are the predecessors of the last level and this level's conversion bucket, without duplicates
+		std::vector<std::vector<std::uint64_t>> threadCandidates(threads);
+		parallelFor(resolved.size(), threads, [&](std::uint64_t begin, std::uint64_t end, int thread) {
+			for (std::uint64_t i = begin; i < end; i++) addPredecessors(resolved[i], threadCandidates[thread]);
+		});
+		std::vector<std::uint64_t> candidates = std::move(buckets[level]);
+		for (auto& c : threadCandidates) candidates.insert(candidates.end(), c.begin(), c.end());
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+		// Values are only written after every thread has checked this level, so checks see whole earlier levels
+		std::vector<std::vector<std::uint64_t>> threadResolved(threads);
+		parallelFor(candidates.size(), threads, [&](std::uint64_t begin, std::uint64_t end, int thread) {
+			for (std::uint64_t i = begin; i < end; i++)
+				if (resolves(candidates[i], level)) threadResolved[thread].push_back(candidates[i]);
+		});
+		resolved.clear();
+		for (auto& r : threadResolved) resolved.insert(resolved.end(), r.begin(), r.end());
+		for (std::uint64_t key : resolved) values[key] = static_cast<std::uint8_t>(level + 2);
+	}
+	return true;
+}
+
+} // namespace
+
+std::string TbMaterial::name() const {
+	std::string s;
+	for (int i = 0; i < count; i++) s += TypeLetters[static_cast<int>(types[i])];
+	return s;
+}
+
+std::uint64_t TbMaterial::entries() const {
+	std::uint64_t n = static_cast<std::uint64_t>(hasPawns ? PawnSlots.count : PawnlessSlots.count);
+	for (int i = 1; i < count; i++) n *= 64;
+	return n;
+}
+
+std::optional<TbMaterial> TbMaterial::parse(const std::string& name) {
+	std::size_t second = name.find('K', 1);
+	if (name.empty() || name[0] != 'K' || second == std::string::npos) return std::nullopt;
+	std::string sides[2] = { name.substr(0, second), name.substr(second) };
+
+	// Each side sorted K Q R B N P, with its strength for choosing which side is white
+	int power[2] = { 0, 0 };
+	std::vector<PieceType> pieces[2];
+	for (int s = 0; s < 2; s++) {
+		for (std::size_t i = 0; i < sides[s].size(); i++) {
+			const char* found = std::strchr(TypeLetters, sides[s][i]);
+			if (!found || *found == '\0') return std::nullopt;
+			PieceType type = static_cast<PieceType>(found - TypeLetters);
+			if ((type == PieceType::King) != (i == 0)) return std::nullopt; // Exactly one king, listed first
+			pieces[s].push_back(type);
+			power[s] += strength(type);
+		}
+		std::stable_sort(pieces[s].begin(), pieces[s].end(), [](PieceType a, PieceType b) {
+			return std::find(NameOrder, NameOrder + 6, a) < std::find(NameOrder, NameOrder + 6, b);
+		});
+	}
+	if (pieces[0].size() + pieces[1].size() > TbMaxPieces) return std::nullopt;
+
+	auto letters = [](const std::vector<PieceType>& side) {
+		std::string s;
+		for (PieceType t : side) s += TypeLetters[static_cast<int>(t)];
+		return s;
+	};
+	bool swap = power[1] > power[0] || (power[1] == power[0] && letters(pieces[1]) < letters(pieces[0]));
+
+	TbMaterial m;
+	for (int s = 0; s < 2; s++) {
+		for (PieceType t : pieces[swap ? 1 - s : s]) {
+			m.colors[m.count] = s == 0 ? White : Black;
+			m.types[m.count] = t;
+			m.hasPawns |= t == PieceType::Pawn;
+			m.count++;
+		}
+	}
+	return m;
+}
+
+std::uint8_t Tablebases::Table::value(Color side, std::uint64_t index) const {
+	if (!raw.empty()) return raw[(side == White ? 0 : entries) + index];
+
+	std::uint64_t block = (side == White ? 0 : blocksPerSide) + index / blockSize;
+	std::uint32_t offset = static_cast<std::uint32_t>(index % blockSize);
+	const std::uint8_t* bytes = data + offsets[block];
+	if (bytes[0] == 0) return bytes[1 + offset];
+	for (const std::uint8_t* run = bytes + 1;; run += 2) {
+		std::uint32_t length = run[0] + 1u;
+		if (offset < length) return run[1];
+		offset -= length;
+	}
+}
+
+bool Tablebases::loadFile(const std::string& path) {
+	auto table = std::make_unique<Table>();
+	if (!table->file.open(path) || table->file.size() < sizeof(TbHeader)) return false;
+
+	TbHeader header;
+	std::memcpy(&header, table->file.data(), sizeof(header));
+	std::string name(header.name, strnlen(header.name, sizeof(header.name)));
+	std::optional<TbMaterial> material = TbMaterial::parse(name);
+	if (std::memcmp(header.magic, "PCTB", 4) != 0 || header.version != TbVersion || !material || material->name() != name
+		|| header.entries != material->entries() || header.blockSize == 0)
+		return false;
+
+	std::uint64_t blocks = 2 * header.blocksPerSide;
+	std::size_t dataStart = sizeof(TbHeader) + (blocks + 1) * sizeof(std::uint64_t);
+	if (table->file.size() < dataStart) return false;
+
+	table->material = *material;
+	table->entries = header.entries;
+	table->blockSize = header.blockSize;
+	table->blocksPerSide = header.blocksPerSide;
+	table->offsets = reinterpret_cast<const std::uint64_t*>(table->file.data() + sizeof(TbHeader));
+	table->data = reinterpret_cast<const std::uint8_t*>(table->file.data() + dataStart);
+	if (dataStart + table->offsets[blocks] != table->file.size()) return false;
+
+	tables[name] = std::move(table);
+	return true;
+}
+
+int Tablebases::load(const std::string& directory) {
+	int loaded = 0;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.path().extension() != ".tb") continue;
+		if (loadFile(entry.path().string())) loaded++;
+	}
+	return loaded;
+}
+
+bool Tablebases::has(const std::string& name) const {
+	std::optional<TbMaterial> material = TbMaterial::parse(name);
+	return material && tables.count(material->name()) > 0;
+}
+
+const Tablebases::Table* Tablebases::find(const Position& position, bool& flipped) const {
+	if (popCount(position.occupied()) > TbMaxPieces) return nullptr;
+
+	std::string sides[2];
+	for (Color c : { White, Black }) {
+		for (PieceType t : NameOrder) {
+			int count = popCount(position.pieces(c, t));
+			sides[c].append(static_cast<std::size_t>(count), TypeLetters[static_cast<int>(t)]);
+		}
+	}
+
+	auto found = tables.find(sides[White] + sides[Black]);
+	flipped = false;
+	if (found == tables.end()) {
+		found = tables.find(sides[Black] + sides[White]);
+		flipped = true;
+	}
+	return found == tables.end() ? nullptr : found->second.get();
+}
+
+std::optional<TbResult> Tablebases::probe(const Position& position) const {
+	if (position.castlingRights() != NoCastling) return std::nullopt; // Tables assume no castling rights
+	if (popCount(position.occupied()) == 2) return TbResult(); // Bare kings
+
+	// Tables have no en passant rights, so a position with one is answered by looking one move ahead
+	if (position.enPassantSquare() != -1) {
+		Position copy = position;
+		MoveList moves;
+		generateLegalMoves(copy, moves);
+		if (moves.empty()) return fromValue(copy.isInCheck(copy.sideToMove()) ? 2 : TbDraw);
+
+		std::optional<TbResult> best;
+		for (const Move& move : moves) {
+			UndoInfo undo;
+			copy.makeMove(move, undo);
+			std::optional<TbResult> child = probe(copy);
+			copy.unmakeMove(move, undo);
+			if (!child) return std::nullopt;
+
+			TbResult mine; // The child's result seen from this side
+			if (child->outcome == TbOutcome::Loss) mine = { TbOutcome::Win, child->plies + 1 };
+			else if (child->outcome == TbOutcome::Win) mine = { TbOutcome::Loss, child->plies + 1 };
+			auto rank = [](const TbResult& r) { return r.outcome == TbOutcome::Win ? 1000 - r.plies : r.outcome == TbOutcome::Draw ? 0 : r.plies - 1000; };
+			if (!best || rank(mine) > rank(*best)) best = mine;
+		}
+		return best;
+	}
+
+	bool flipped = false;
+	const Table* table = find(position, flipped);
+	if (!table) return std::nullopt;
+
+	int squares[TbMaxPieces];
+	squaresOf(table->material, position, flipped, squares);
+	Color side = flipped ? ~position.sideToMove() : position.sideToMove();
+	std::uint8_t value = table->value(side, encode(table->material, squares));
+	if (value == TbInvalid) return std::nullopt;
+	return fromValue(value);
+}
+
+bool Tablebases::bestMove(Position& position, Move& move) const {
+	MoveList moves;
+	generateLegalMoves(position, moves);
+
+	int bestRank = 0;
+	bool found = false;
+	for (const Move& m : moves) {
+		UndoInfo undo;
+		position.makeMove(m, undo);
+		std::optional<TbResult> child = probe(position);
+		position.unmakeMove(m, undo);
+		if (!child) return false;
+
+		// Quickest win first, then a draw, then the longest loss
+		int rank = child->outcome == TbOutcome::Loss ? 1000 - child->plies : child->outcome == TbOutcome::Draw ? 0 : child->plies - 1000;
+		if (!found || rank > bestRank) {
+			bestRank = rank;
+			move = m;
+			found = true;
+		}
+	}
+	return found;
+}
+
+bool Tablebases::buildTable(const TbMaterial& material, const std::string& directory, int threads, std::ostream* log) {
+	auto start = std::chrono::steady_clock::now();
+	Generator generator(material, *this, threads);
+	if (!generator.run(log)) return false;
+
+	// Unreachable positions copy the value before them, so they lengthen runs instead of breaking them
+	std::vector<std::uint8_t>& values = generator.values;
+	std::uint64_t entries = material.entries();
+	std::uint64_t counts[2][3] = {}; // Side, then loss, draw, win
+	std::uint64_t longestKey = 0;
+	int longest = -1;
+	for (std::uint64_t key = 0; key < values.size(); key++) {
+		if (values[key] == TbInvalid) {
+			values[key] = key % entries == 0 ? TbDraw : values[key - 1];
+			continue;
+		}
+		TbResult result = fromValue(values[key]);
+		counts[key < entries ? 0 : 1][static_cast<int>(result.outcome)]++;
+		if (result.outcome == TbOutcome::Win && result.plies > longest) {
+			longest = result.plies;
+			longestKey = key;
+		}
+	}
+
+	std::uint64_t blocksPerSide = (entries + TbBlockSize - 1) / TbBlockSize;
+	std::vector<std::uint64_t> offsets;
+	std::vector<std::uint8_t> data;
+	for (int side = 0; side < 2; side++) {
+		for (std::uint64_t block = 0; block < blocksPerSide; block++) {
+			offsets.push_back(data.size());
+			std::uint64_t first = block * TbBlockSize;
+			compressBlock(&values[side * entries + first], static_cast<std::size_t>(std::min<std::uint64_t>(TbBlockSize, entries - first)), data);
+		}
+	}
+	offsets.push_back(data.size());
+
+	TbHeader header{};
+	std::memcpy(header.magic, "PCTB", 4);
+	header.version = TbVersion;
+	std::string name = material.name();
+	std::memcpy(header.name, name.c_str(), std::min(name.size(), sizeof(header.name)));
+	header.blockSize = TbBlockSize;
+	header.entries = entries;
+	header.blocksPerSide = blocksPerSide;
+
+	std::string path = (std::filesystem::path(directory) / (name + ".tb")).string();
+	std::ofstream out(path, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+	out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	if (!out) {
+		if (log) *log << "ERROR: Could not write " << path << std::endl;
+		return false;
+	}
+
+	if (log) {
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		*log << name << ": " << entries << " positions per side in " << seconds << " s, "
+			<< (sizeof(header) + offsets.size() * 8 + data.size()) / 1024 << " KB written to " << path << "\n";
+		for (int side = 0; side < 2; side++)
+			*log << "  " << (side == 0 ? "White" : "Black") << " to move: " << counts[side][2] << " wins, "
+				<< counts[side][1] << " draws, " << counts[side][0] << " losses\n";
+		if (longest >= 0) {
+			int squares[TbMaxPieces];
+			Position position;
+			decode(material, longestKey % entries, squares);
+			setUp(material, squares, longestKey < entries ? White : Black, position);
+			*log << "  Longest mate: " << (longest + 1) / 2 << " moves, " << position.toFen() << "\n";
+		}
+		log->flush();
+	}
+
+	// Kept uncompressed, so bigger tables built next can probe it quickly
+	auto table = std::make_unique<Table>();
+	table->material = material;
+	table->entries = entries;
+	table->raw = std::move(values);
+	tables[name] = std::move(table);
+	return true;
+}
+
+bool Tablebases::generate(const std::string& name, const std::string& directory, int threads, std::ostream* log) {
+	std::optional<TbMaterial> material = TbMaterial::parse(name);
+	if (!material) {
+		if (log) *log << "ERROR: Invalid material " << name << ", expected 3 to " << TbMaxPieces << " pieces such as KQK or KRPKR" << std::endl;
+		return false;
+	}
+	std::string canonical = material->name();
+	if (tables.count(canonical)) return true;
+	if (material->count < 3) return true; // Bare kings are always drawn
+	if (loadFile((std::filesystem::path(directory) / (canonical + ".tb")).string())) return true;
+
+	// Every capture or promotion leads into a smaller or different table, which has to exist first
+	for (int i = 1; i < material->count; i++) {
+		if (material->types[i] == PieceType::King) continue;
+		for (int replace = 0; replace <= 4; replace++) { // 0 removes the piece, 1-4 promote a pawn to N B R Q
+			if (replace > 0 && material->types[i] != PieceType::Pawn) break;
+			std::string sides[2];
+			for (int j = 0; j < material->count; j++) {
+				if (j == i && replace == 0) continue;
+				PieceType t = j == i ? static_cast<PieceType>(replace) : material->types[j];
+				sides[material->colors[j]] += TypeLetters[static_cast<int>(t)];
+			}
+			if (!generate(sides[White] + sides[Black], directory, threads, log)) return false;
+		}
+	}
+	return buildTable(*material, directory, threads, log);
+}
@@ -0,0 +1,74 @@
+// Tablebase.hpp
+// Tablebases class
+// Endgame tablebases with exact distance to mate, built by retrograde analysis and probed from compressed files
+
+#pragma once
+#include "MappedFile.hpp"
+#include "Move.hpp"
+#include "Position.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+constexpr int TbMaxPieces = 5;
+
+enum class TbOutcome {
+	Loss, Draw, Win
+};
+
+// Result for the side to move with best play from both sides
+struct TbResult {
+	TbOutcome outcome = TbOutcome::Draw;
+	int plies = 0; // Plies until mate, 0 for a draw or when already checkmated
+	int movesToMate() const { return (plies + 1) / 2; }
+};
+
+// Pieces of one table. White is the stronger side, each side is listed king first, then Q R B N P.
+struct TbMaterial {
+	int count = 0;
+	Color colors[TbMaxPieces] = {};
+	PieceType types[TbMaxPieces] = {};
+	bool hasPawns = false;
+
+	std::string name() const; // Such as KQKR
+	std::uint64_t entries() const; // Positions per side to move, including unreachable ones
+	static std::optional<TbMaterial> parse(const std::string& name); // Accepts either side first, returns the canonical order
+};
+
+// Tables are found by material, either from .tb files in a directory or from generate, which keeps them in memory
+class Tablebases {
+private:
+	struct Table {
+		TbMaterial material;
+		std::uint64_t entries = 0;
+		std::vector<std::uint8_t> raw; // Uncompressed values for both sides, only for tables generated in this run
+		MappedFile file; // Compressed file, otherwise
+		const std::uint64_t* offsets = nullptr; // Start of each block in data, both sides, plus the end
+		const std::uint8_t* data = nullptr;
+		std::uint32_t blockSize = 0;
+		std::uint64_t blocksPerSide = 0;
+
+		std::uint8_t value(Color side, std::uint64_t index) const;
+	};
+
+	std::map<std::string, std::unique_ptr<Table>> tables;
+
+	const Table* find(const Position& position, bool& flipped) const; // Table for the position's material, flipped if colors are swapped
+	bool loadFile(const std::string& path);
+	bool buildTable(const TbMaterial& material, const std::string& directory, int threads, std::ostream* log);
+
+public:
+	int load(const std::string& directory); // Maps every .tb file in the directory, returns how many were loaded
+	bool has(const std::string& name) const;
+	int size() const { return static_cast<int>(tables.size()); }
+
+	std::optional<TbResult> probe(const Position& position) const; // Empty if no table covers the position
+	bool bestMove(Position& position, Move& move) const; // Fastest win, else a drawing move, else the slowest loss
+
+	// Builds the table and any smaller tables it converts into, writing each to directory as NAME.tb
+	bool generate(const std::string& name, const std::string& directory, int threads, std::ostream* log = nullptr);
+};
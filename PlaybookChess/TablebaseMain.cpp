@@ -0,0 +1,72 @@
+// TablebaseMain.cpp
+// Headless endgame tablebase tool, no window or SFML needed
+// Usage: tbgen <NAME>... [--dir d] [--threads n]   builds each table, such as KQK or KRPKR, and the smaller tables it needs
+//        tbgen probe <dir> <fen>                    prints the result and best move for a position
+
+#include "Notation.hpp"
+#include "Tablebase.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int probe(const std::string& directory, const std::string& fen) {
+	Tablebases tablebases;
+	if (tablebases.load(directory) == 0) {
+		std::cerr << "ERROR: No tables found in " << directory << std::endl;
+		return 1;
+	}
+	Position position;
+	if (!position.setFromFen(fen)) {
+		std::cerr << "ERROR: Invalid FEN: " << fen << std::endl;
+		return 1;
+	}
+
+	std::optional<TbResult> result = tablebases.probe(position);
+	if (!result) {
+		std::cerr << "ERROR: No table covers " << fen << std::endl;
+		return 1;
+	}
+	if (result->outcome == TbOutcome::Draw) std::cout << "Draw";
+	else if (result->plies == 0) std::cout << "Checkmated";
+	else std::cout << (result->outcome == TbOutcome::Win ? "Mate in " : "Mated in ") << result->movesToMate() << " (" << result->plies << " plies)";
+
+	Move best;
+	if (tablebases.bestMove(position, best)) std::cout << ", best move " << moveToSan(position, best);
+	std::cout << std::endl;
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	std::string command = argc > 1 ? argv[1] : "";
+	if (command == "probe" && argc >= 4) {
+		std::string fen;
+		for (int i = 3; i < argc; i++) fen += std::string(i > 3 ? " " : "") + argv[i];
+		return probe(argv[2], fen);
+	}
+
+	std::vector<std::string> names;
+	std::string directory = ".";
+	int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--dir" && i + 1 < argc) directory = argv[++i];
+		else if (arg == "--threads" && i + 1 < argc) threads = std::atoi(argv[++i]);
+		else names.push_back(arg);
+	}
+	if (names.empty()) {
+		std::cerr << "Usage: tbgen <NAME>... [--dir d] [--threads n]\n"
+			<< "       tbgen probe <dir> <fen>" << std::endl;
+		return 2;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	Tablebases tablebases;
+	for (const std::string& name : names)
+		if (!tablebases.generate(name, directory, threads, &std::cout)) return 1;
+	return 0;
+}
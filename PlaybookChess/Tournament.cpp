@@ -0,0 +1,339 @@
+// Tournament.cpp
+// Handles self-play matches, adjudication, PGN output, and match statistics
+
+#include "Tournament.hpp"
+#include "Bench.hpp"
+#include "MoveGen.hpp"
+#include "Rules.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+bool EngineConfig::parse(const std::string& spec) {
+	std::stringstream items(spec);
+	std::string item;
+	while (std::getline(items, item, ',')) {
+		std::size_t eq = item.find('=');
+		if (eq == std::string::npos) return false;
+		std::string key = item.substr(0, eq), value = item.substr(eq + 1);
+		if (key == "name") name = value;
+		else if (key == "depth") depth = std::clamp(std::atoi(value.c_str()), 1, MaxPly - 1);
+		else if (key == "movetime") movetimeMs = std::atoi(value.c_str());
+		else if (key == "nodes") nodes = std::strtoull(value.c_str(), nullptr, 10);
+		else if (key == "hash") hashMb = std::max(1, std::atoi(value.c_str()));
+		else if (key == "tc") { // Seconds, optionally followed by +increment
+			std::size_t plus = value.find('+');
+			baseMs = static_cast<long long>(std::atof(value.substr(0, plus).c_str()) * 1000);
+			incrementMs = plus == std::string::npos ? 0 : static_cast<long long>(std::atof(value.substr(plus + 1).c_str()) * 1000);
+			clockSet = true;
+		}
+		else return false;
+	}
+	return true;
+}
+
+bool EngineConfig::usesClock() const {
+	return movetimeMs == 0 && nodes == 0 && baseMs > 0 && (clockSet || depth == MaxPly - 1);
+}
+
+double SprtBounds::lower() const { return std::log(beta / (1 - alpha)); }
+double SprtBounds::upper() const { return std::log((1 - beta) / alpha); }
+
+// Expected score for an Elo difference, and back
+static double scoreFromElo(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+static double eloFromScore(double score) {
+	score = std::clamp(score, 1e-6, 1 - 1e-6);
+	return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double MatchStats::score() const {
+	return games() ? (wins + 0.5 * draws) / games() : 0.5;
+}
+
+// Variance of one game's points around the mean score
+static double perGameVariance(const MatchStats& s) {
+	if (s.games() == 0) return 0.0;
+	double mean = s.score();
+	return (s.wins * (1 - mean) * (1 - mean) + s.draws * (0.5 - mean) * (0.5 - mean) + s.losses * mean * mean) / s.games();
+}
+
+double MatchStats::elo() const {
+	return eloFromScore(score());
+}
+
+double MatchStats::eloError() const {
+	if (games() == 0) return 0.0;
+	double margin = 1.959964 * std::sqrt(perGameVariance(*this) / games());
+	return (eloFromScore(score() + margin) - eloFromScore(score() - margin)) / 2;
+}
+
+double MatchStats::los() const {
+	if (wins + losses == 0) return 0.5;
+	return 0.5 * (1 + std::erf((wins - losses) / std::sqrt(2.0 * (wins + losses))));
+}
+
+// Normal approximation of the trinomial likelihood ratio, the form most engine testing frameworks use
+double MatchStats::llr(double elo0, double elo1) const {
+	double variance = perGameVariance(*this);
+	if (games() == 0 || variance <= 0) return 0.0;
+	double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+	return (s1 - s0) * (2 * score() - s0 - s1) * games() / (2 * variance);
+}
+
+// Tournament constructor
+Tournament::Tournament(const TournamentOptions& tournamentOptions) : options(tournamentOptions) {
+	if (options.engines[0].name == options.engines[1].name) { // PGN readers need two distinct players
+		options.engines[0].name += " A";
+		options.engines[1].name += " B";
+	}
+}
+
+bool Tournament::loadOpenings() {
+	openings.clear();
+	if (options.openingsPath.empty()) return true;
+	std::ifstream in(options.openingsPath);
+	if (!in) return false;
+
+	// EPD operations after the four position fields are ignored, FEN move counters are kept
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream fields(line);
+		std::string field, fen;
+		for (int i = 0; i < 4 && fields >> field; i++) fen += (i ? " " : "") + field;
+		std::string halfmove, fullmove;
+		fields >> halfmove >> fullmove;
+		auto isNumber = [](const std::string& text) { // Compared as characters, so bytes above 127 are just not digits
+			return !text.empty() && std::all_of(text.begin(), text.end(), [](char ch) { return ch >= '0' && ch <= '9'; });
+		};
+		bool counters = isNumber(halfmove) && isNumber(fullmove);
+		fen += counters ? " " + halfmove + " " + fullmove : " 0 1";
+
+		Position position;
+		if (!fen.empty() && fen[0] != '#' && position.setFromFen(fen)) openings.push_back(fen);
+	}
+	return !openings.empty();
+}
+
+static bool isInsufficientMaterial(const Position& position) {
+	int pieces = popCount(position.occupied());
+	if (pieces == 2) return true;
+	return pieces == 3 && (position.pieces(PieceType::Knight) | position.pieces(PieceType::Bishop)) != 0;
+}
+
+// The engines are deterministic, so without varied openings every pair of games would repeat the first one.
+// Both games of a pair draw the same line, and a line that ends the game is replaced by the next draw.
+std::string Tournament::randomOpening(int pair) const {
+	constexpr int MaxDraws = 100; // Past this the pair starts from the longest line that left moves to play
+	std::mt19937_64 rng(options.seed * 0x9E3779B97F4A7C15ULL + static_cast<std::uint64_t>(pair));
+	std::string longest = StartFen;
+	int longestPlies = 0;
+	MoveList moves;
+	for (int draw = 0; draw < MaxDraws; draw++) {
+		Position position;
+		position.setFromFen(StartFen);
+		for (int ply = 0; ; ply++) {
+			generateLegalMoves(position, moves);
+			if (moves.empty()) break;
+			if (ply == options.randomPlies) return position.toFen();
+			if (ply > longestPlies) {
+				longestPlies = ply;
+				longest = position.toFen();
+			}
+			UndoInfo undo;
+			position.makeMove(moves.moves[rng() % moves.count], undo); // Modulo rather than a distribution, so every platform picks the same moves
+		}
+	}
+	return longest;
+}
+
+Tournament::GameRecord Tournament::playGame(int index, Player* players[2]) const {
+	GameRecord game;
+	game.round = index + 1;
+	game.whiteEngine = index % 2; // Each opening is played once with each color
+	if (!openings.empty()) game.startFen = openings[(index / 2) % openings.size()];
+	else game.startFen = options.randomPlies > 0 ? randomOpening(index / 2) : StartFen;
+
+	Rules rules;
+	rules.reset(game.startFen);
+	for (int e = 0; e < 2; e++) players[e]->tt.clear(); // Games stay independent of which worker played them
+	long long clock[2] = { options.engines[0].baseMs, options.engines[1].baseMs };
+
+	auto finish = [&](const char* result, Termination termination) {
+		game.result = result;
+		game.termination = termination;
+	};
+
+	while (true) {
+		const Position& position = rules.getPosition();
+		bool whiteToMove = position.sideToMove() == White;
+		GameResult outcome = rules.result();
+		if (outcome == GameResult::WhiteWins) { finish("1-0", Termination::Checkmate); break; }
+		if (outcome == GameResult::BlackWins) { finish("0-1", Termination::Checkmate); break; }
+		if (outcome == GameResult::Stalemate) { finish("1/2-1/2", Termination::Stalemate); break; }
+		if (outcome == GameResult::Repetition) { finish("1/2-1/2", Termination::Repetition); break; }
+		if (position.halfmoves() >= 100) { finish("1/2-1/2", Termination::FiftyMoves); break; }
+		if (isInsufficientMaterial(position)) { finish("1/2-1/2", Termination::InsufficientMaterial); break; }
+		if (static_cast<int>(game.sanMoves.size()) >= options.maxPlies) { finish("1/2-1/2", Termination::MaxPlies); break; }
+
+		int engine = whiteToMove ? game.whiteEngine : 1 - game.whiteEngine;
+		const EngineConfig& config = options.engines[engine];
+		SearchLimits limits;
+		limits.depth = config.depth;
+		limits.nodes = config.nodes;
+		limits.movetimeMs = config.movetimeMs;
+		bool clocked = config.usesClock();
+		if (clocked) limits.movetimeMs = allocateMoveTime(clock[engine], config.incrementMs);
+
+		auto start = std::chrono::steady_clock::now();
+		SearchResult result = players[engine]->search.think(position, limits, rules.getKeyHistory());
+		if (clocked) {
+			clock[engine] -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+			if (clock[engine] < 0) { finish(whiteToMove ? "0-1" : "1-0", Termination::TimeForfeit); break; }
+			clock[engine] += config.incrementMs;
+		}
+		if (!result.hasMove) break; // Unreachable, positions without moves ended above
+
+		game.sanMoves.push_back(rules.applyMove(result.bestMove).notation);
+	}
+	return game;
+}
+
+static const char* terminationText(Termination t) {
+	switch (t) {
+	case Termination::Checkmate: return "checkmate";
+	case Termination::Stalemate: return "stalemate";
+	case Termination::Repetition: return "threefold repetition";
+	case Termination::FiftyMoves: return "fifty-move rule";
+	case Termination::InsufficientMaterial: return "insufficient material";
+	case Termination::MaxPlies: return "move limit";
+	case Termination::TimeForfeit: return "time forfeit";
+	}
+	return "";
+}
+
+// PGN TimeControl of the first clocked side, "-" when both played on depth, movetime or nodes
+static std::string timeControlTag(const EngineConfig& white, const EngineConfig& black) {
+	const EngineConfig* clocked = white.usesClock() ? &white : black.usesClock() ? &black : nullptr;
+	if (!clocked) return "-";
+	std::ostringstream tag;
+	tag << clocked->baseMs / 1000.0 << "+" << clocked->incrementMs / 1000.0;
+	return tag.str();
+}
+
+void Tournament::recordGame(const GameRecord& game, std::ostream* pgn, std::ostream& log) {
+	std::lock_guard<std::mutex> lock(resultMutex);
+	double whitePoints = game.result == "1-0" ? 1.0 : game.result == "0-1" ? 0.0 : 0.5;
+	double points = game.whiteEngine == 0 ? whitePoints : 1.0 - whitePoints; // First engine's view
+	if (points == 1.0) stats.wins++;
+	else if (points == 0.0) stats.losses++;
+	else stats.draws++;
+
+	if (pgn) {
+		std::time_t now = std::time(nullptr);
+		char date[16];
+		std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+		const EngineConfig& white = options.engines[game.whiteEngine];
+		const EngineConfig& black = options.engines[1 - game.whiteEngine];
+
+		*pgn << "[Event \"PlaybookChess self-play\"]\n[Site \"?\"]\n[Date \"" << date << "\"]\n[Round \"" << game.round << "\"]\n"
+			<< "[White \"" << white.name << "\"]\n[Black \"" << black.name << "\"]\n[Result \"" << game.result << "\"]\n";
+		if (game.startFen != StartFen) *pgn << "[SetUp \"1\"]\n[FEN \"" << game.startFen << "\"]\n";
+		*pgn << "[TimeControl \"" << timeControlTag(white, black) << "\"]\n"
+			<< "[Termination \"" << (game.termination == Termination::TimeForfeit ? "time forfeit" : game.termination == Termination::MaxPlies ? "adjudication" : "normal") << "\"]\n\n";
+
+		// Move numbers continue from the opening position, wrapped near 80 columns
+		Position start;
+		start.setFromFen(game.startFen);
+		int moveNumber = start.fullmoves();
+		bool white_ = start.sideToMove() == White;
+		std::string line;
+		auto emit = [&](const std::string& token) {
+			if (!line.empty() && line.size() + token.size() + 1 > 79) {
+				*pgn << line << "\n";
+				line.clear();
+			}
+			line += (line.empty() ? "" : " ") + token;
+		};
+		for (std::size_t i = 0; i < game.sanMoves.size(); i++) {
+			if (white_) emit(std::to_string(moveNumber) + ".");
+			else if (i == 0) emit(std::to_string(moveNumber) + "...");
+			emit(game.sanMoves[i]);
+			if (!white_) moveNumber++;
+			white_ = !white_;
+		}
+		emit("{" + std::string(terminationText(game.termination)) + "}");
+		emit(game.result);
+		*pgn << line << "\n\n";
+		pgn->flush();
+	}
+
+	if (options.sprt.enabled) {
+		double llr = stats.llr(options.sprt.elo0, options.sprt.elo1);
+		if (llr <= options.sprt.lower() || llr >= options.sprt.upper()) stopRequested.store(true);
+	}
+	if (stats.games() - reported >= options.reportEvery || stopRequested.load()) {
+		printProgress(log);
+		reported = stats.games();
+	}
+}
+
+void Tournament::printProgress(std::ostream& log) const {
+	log << "Games " << stats.games() << ": +" << stats.wins << " =" << stats.draws << " -" << stats.losses
+		<< std::fixed << std::setprecision(1) << ", Elo " << stats.elo() << " +/- " << stats.eloError()
+		<< ", LOS " << stats.los() * 100 << "%";
+	if (options.sprt.enabled)
+		log << std::setprecision(2) << ", LLR " << stats.llr(options.sprt.elo0, options.sprt.elo1)
+			<< " [" << options.sprt.lower() << ", " << options.sprt.upper() << "]";
+	log << std::defaultfloat << std::endl;
+}
+
+MatchStats Tournament::run(std::ostream& log) {
+	std::ofstream pgnFile;
+	std::ostream* pgn = nullptr;
+	if (!options.pgnPath.empty()) {
+		pgnFile.open(options.pgnPath);
+		if (pgnFile) pgn = &pgnFile;
+		else log << "ERROR: Could not write " << options.pgnPath << ", continuing without PGN" << std::endl;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	double cpuStart = processCpuSeconds();
+	int threads = std::clamp(options.concurrency, 1, std::max(1, options.games));
+
+	// Each worker keeps its own pair of engines for every game it plays, the next game index is the only shared state
+	auto work = [&] {
+		Player first(options.engines[0].hashMb), second(options.engines[1].hashMb);
+		Player* players[2] = { &first, &second };
+		for (int i = nextGame++; i < options.games && !stopRequested.load(); i = nextGame++)
+			recordGame(playGame(i, players), pgn, log);
+	};
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads; t++) pool.emplace_back(work);
+	work();
+	for (auto& t : pool) t.join();
+
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	double cpu = processCpuSeconds() - cpuStart;
+	if (stats.games() != reported) printProgress(log);
+
+	log << "\n" << options.engines[0].name << " vs " << options.engines[1].name << ": " << stats.games() << " games\n";
+	log << std::fixed << std::setprecision(1) << "Elo difference: " << stats.elo() << " +/- " << stats.eloError()
+		<< " (95%), LOS " << stats.los() * 100 << "%, score " << stats.score() * 100 << "%\n";
+	if (options.sprt.enabled) {
+		double llr = stats.llr(options.sprt.elo0, options.sprt.elo1);
+		log << std::setprecision(2) << "SPRT elo0 " << options.sprt.elo0 << " elo1 " << options.sprt.elo1 << ": LLR " << llr
+			<< " [" << options.sprt.lower() << ", " << options.sprt.upper() << "], "
+			<< (llr >= options.sprt.upper() ? "H1 accepted" : llr <= options.sprt.lower() ? "H0 accepted" : "inconclusive") << "\n";
+	}
+	log << std::setprecision(1) << "Time: " << wall << " s, " << (wall > 0 ? stats.games() * 3600.0 / wall : 0.0) << " games/hour\n";
+	log << "CPU: " << cpu << " s, " << (wall > 0 ? 100.0 * cpu / (wall * threads) : 0.0) << "% of " << threads
+		<< (threads == 1 ? " thread" : " threads") << std::defaultfloat << std::endl;
+	return stats;
+}
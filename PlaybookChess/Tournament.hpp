@@ -0,0 +1,103 @@
+// Tournament.hpp
+// Tournament class
+// Headless engine-vs-engine matches played concurrently, with adjudication, PGN output, Elo estimates, and SPRT
+
+#pragma once
+#include "Move.hpp"
+#include "Search.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One side of the match. A movetime or node budget replaces the clock when set.
+struct EngineConfig {
+	std::string name = "PlaybookChess";
+	int depth = MaxPly - 1;
+	int movetimeMs = 0;
+	std::uint64_t nodes = 0;
+	int hashMb = 16;
+	long long baseMs = 10000; // Clock per game
+	long long incrementMs = 100;
+	bool clockSet = false; // tc given, so a depth limit no longer stands in for the clock
+
+	bool parse(const std::string& spec); // Comma separated key=value: name, depth, movetime, nodes, hash, tc (seconds+increment)
+	bool usesClock() const; // Plays on baseMs+incrementMs rather than a fixed depth, time or node budget
+};
+
+// Sequential probability ratio test between two Elo hypotheses
+struct SprtBounds {
+	bool enabled = false;
+	double elo0 = 0.0, elo1 = 5.0;
+	double alpha = 0.05, beta = 0.05;
+	double lower() const; // Accept elo0 at or below this log-likelihood ratio
+	double upper() const; // Accept elo1 at or above it
+};
+
+struct TournamentOptions {
+	EngineConfig engines[2];
+	int games = 100; // Openings are played in pairs with colors swapped, so an even count is fairest
+	int concurrency = 1; // Games played at once, each engine searches on one thread
+	int maxPlies = 400; // Drawn once reached
+	std::string openingsPath; // EPD or FEN lines, random openings if empty
+	int randomPlies = 8; // Without an openings file, each pair of games starts after this many random legal plies
+	std::uint64_t seed = 1; // Random openings depend only on the seed and the pair, so a run can be repeated
+	std::string pgnPath; // No PGN if empty
+	SprtBounds sprt;
+	int reportEvery = 10; // Progress line after this many finished games
+};
+
+enum class Termination {
+	Checkmate, Stalemate, Repetition, FiftyMoves, InsufficientMaterial, MaxPlies, TimeForfeit
+};
+
+// Results from the first engine's point of view
+struct MatchStats {
+	int wins = 0, draws = 0, losses = 0;
+
+	int games() const { return wins + draws + losses; }
+	double score() const; // Points per game
+	double elo() const;
+	double eloError() const; // Half width of the 95% interval
+	double los() const; // Likelihood of superiority
+	double llr(double elo0, double elo1) const; // Log-likelihood ratio of elo1 over elo0
+};
+
+class Tournament {
+private:
+	struct GameRecord {
+		int round = 0;
+		int whiteEngine = 0; // Index into engines
+		std::string startFen;
+		std::vector<std::string> sanMoves;
+		std::string result = "*"; // 1-0, 0-1, or 1/2-1/2
+		Termination termination = Termination::MaxPlies;
+	};
+
+	// One engine's search state, every worker thread owns one per side
+	struct Player {
+		TranspositionTable tt;
+		Search search;
+		explicit Player(int hashMb) : tt(static_cast<std::size_t>(hashMb)), search(tt, 1) {}
+	};
+
+	TournamentOptions options;
+	std::vector<std::string> openings;
+	MatchStats stats;
+	int reported = 0; // Games in the last progress line
+	std::mutex resultMutex; // Guards stats, reported, the PGN stream, and the log
+	std::atomic<int> nextGame{ 0 };
+	std::atomic<bool> stopRequested{ false }; // Set once the SPRT reaches a bound
+
+	std::string randomOpening(int pair) const; // FEN after randomPlies random legal plies from the start position
+	GameRecord playGame(int index, Player* players[2]) const;
+	void recordGame(const GameRecord& game, std::ostream* pgn, std::ostream& log);
+	void printProgress(std::ostream& log) const;
+
+public:
+	explicit Tournament(const TournamentOptions& tournamentOptions); // Constructor
+	bool loadOpenings(); // Reads openingsPath, false if it is set but unreadable or has no valid positions
+	MatchStats run(std::ostream& log); // Plays the match, returns once every game finished or the SPRT stopped it
+};
@@ -0,0 +1,76 @@
+// TournamentMain.cpp
+// Headless self-play match between two engine configurations
+// Usage: selfplay [--engine spec] [--engine spec] [--games n] [--concurrency n] [--tc sec+inc] [--max-plies n]
+//                 [--openings file.epd] [--random-plies n] [--seed n] [--pgn out.pgn] [--sprt elo0 elo1 [alpha beta]] [--report n]
+// Without --openings each pair of games starts from random legal plies, 8 by default, drawn from the seed.
+// An engine spec is comma separated key=value pairs, such as name=new,depth=8,hash=32 or movetime=50 or tc=5+0.05.
+// Exits with 1 if the SPRT accepted elo0, so a script can reject a change.
+
+#include "Tournament.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+	TournamentOptions options;
+	std::vector<std::string> specs;
+	std::string timeControl;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i], value = argv[i + 1];
+		if (arg == "--engine") specs.push_back(value);
+		else if (arg == "--tc") timeControl = value;
+		else if (arg == "--games") options.games = std::atoi(value.c_str());
+		else if (arg == "--concurrency") options.concurrency = std::atoi(value.c_str());
+		else if (arg == "--max-plies") options.maxPlies = std::atoi(value.c_str());
+		else if (arg == "--openings") options.openingsPath = value;
+		else if (arg == "--random-plies") options.randomPlies = std::max(0, std::atoi(value.c_str()));
+		else if (arg == "--seed") options.seed = std::strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "--pgn") options.pgnPath = value;
+		else if (arg == "--report") options.reportEvery = std::max(1, std::atoi(value.c_str()));
+		else if (arg == "--sprt" && i + 2 < argc) {
+			options.sprt.enabled = true;
+			options.sprt.elo0 = std::atof(argv[i + 1]);
+			options.sprt.elo1 = std::atof(argv[i + 2]);
+			i++;
+			if (i + 3 < argc && argv[i + 2][0] != '-') { // Optional error rates
+				options.sprt.alpha = std::atof(argv[i + 2]);
+				options.sprt.beta = std::atof(argv[i + 3]);
+				i += 2;
+			}
+		}
+		else {
+			std::cerr << "ERROR: Unknown option: " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	if (specs.size() > 2) {
+		std::cerr << "ERROR: At most two engines" << std::endl;
+		return 1;
+	}
+	for (std::size_t e = 0; e < specs.size(); e++) { // The shared clock first, so an engine's own tc wins
+		if ((!timeControl.empty() && !options.engines[e].parse("tc=" + timeControl)) || !options.engines[e].parse(specs[e])) {
+			std::cerr << "ERROR: Invalid engine: " << specs[e] << std::endl;
+			return 1;
+		}
+	}
+	if (specs.size() < 2 && !timeControl.empty()) {
+		for (std::size_t e = specs.size(); e < 2; e++) options.engines[e].parse("tc=" + timeControl);
+	}
+
+	if (options.sprt.enabled && options.openingsPath.empty() && options.randomPlies == 0) { // Every game pair would be the same
+		std::cerr << "ERROR: SPRT needs --openings or --random-plies above 0" << std::endl;
+		return 1;
+	}
+
+	Tournament tournament(options);
+	if (!tournament.loadOpenings()) {
+		std::cerr << "ERROR: No valid positions in " << options.openingsPath << std::endl;
+		return 1;
+	}
+	MatchStats stats = tournament.run(std::cout);
+	return options.sprt.enabled && stats.llr(options.sprt.elo0, options.sprt.elo1) <= options.sprt.lower() ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+// TranspositionTable.cpp
+// Handles transposition table storage and lookup
+
+#include "TranspositionTable.hpp"
+
+// Entry packing, low to high bits: move 16, score 16, depth 8, bound 2, generation 6
+static std::uint64_t pack(const TTData& e, std::uint8_t generation) {
+	return e.move.raw()
+		| (static_cast<std::uint64_t>(static_cast<std::uint16_t>(e.score)) << 16)
+		| (static_cast<std::uint64_t>(e.depth & 0xFF) << 32)
+		| (static_cast<std::uint64_t>(e.bound) << 40)
+		| (static_cast<std::uint64_t>(generation & 63) << 42);
+}
+
+static TTData unpack(std::uint64_t data) {
+	TTData e;
+	e.move = Move::fromRaw(static_cast<std::uint16_t>(data & 0xFFFF));
+	e.score = static_cast<std::int16_t>((data >> 16) & 0xFFFF);
+	e.depth = static_cast<std::int8_t>((data >> 32) & 0xFF);
+	e.bound = static_cast<Bound>((data >> 40) & 3);
+	return e;
+}
+
+static int generationOf(std::uint64_t data) { return static_cast<int>((data >> 42) & 63); }
+
+// TranspositionTable constructor
+TranspositionTable::TranspositionTable(std::size_t megabytes) {
+	resize(megabytes);
+}
+
+void TranspositionTable::resize(std::size_t megabytes) {
+	std::size_t wanted = (megabytes ? megabytes : 1) * 1024 * 1024 / sizeof(Bucket);
+	std::size_t count = 1;
+	while (count * 2 <= wanted) count *= 2; // Power of two so the index is a mask
+
+	buckets = std::make_unique<Bucket[]>(count);
+	bucketCount = count;
+	generation = 0;
+}
+
+void TranspositionTable::clear() {
+	for (std::size_t i = 0; i < bucketCount; i++) {
+		for (Slot& s : buckets[i].slots) {
+			s.check.store(0, std::memory_order_relaxed);
+			s.data.store(0, std::memory_order_relaxed);
+		}
+	}
+	generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+	generation = (generation + 1) & 63;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTData& out) const {
+	const Bucket& b = bucketFor(key);
+	for (const Slot& s : b.slots) {
+		std::uint64_t data = s.data.load(std::memory_order_relaxed);
+		std::uint64_t check = s.check.load(std::memory_order_relaxed);
+		if ((check ^ data) == key && data != 0) {
+			out = unpack(data);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, const TTData& entry) {
+	Bucket& b = bucketFor(key);
+
+	// Replace the entry for the same key, else an empty slot, else the shallowest and oldest entry
+	Slot* target = &b.slots[0];
+	int worst = 1 << 30;
+	for (Slot& s : b.slots) {
+		std::uint64_t data = s.data.load(std::memory_order_relaxed);
+		std::uint64_t check = s.check.load(std::memory_order_relaxed);
+		if (data == 0 || (check ^ data) == key) {
+			target = &s;
+			break;
+		}
+		int age = (generation - generationOf(data)) & 63;
+		int value = static_cast<std::int8_t>((data >> 32) & 0xFF) - 8 * age;
+		if (value < worst) {
+			worst = value;
+			target = &s;
+		}
+	}
+
+	std::uint64_t data = pack(entry, generation);
+	target->data.store(data, std::memory_order_relaxed);
+	target->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+	int used = 0;
+	int samples = 0;
+	for (std::size_t i = 0; i < bucketCount && i < 250; i++) {
+		for (const Slot& s : buckets[i].slots) {
+			std::uint64_t data = s.data.load(std::memory_order_relaxed);
+			if (data != 0 && generationOf(data) == generation) used++;
+			samples++;
+		}
+	}
+	return samples ? used * 1000 / samples : 0;
+}
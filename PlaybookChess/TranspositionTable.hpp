@@ -0,0 +1,52 @@
+// TranspositionTable.hpp
+// TranspositionTable class
+// Fixed-size hash table of search results, shared by threads without locks
+
+#pragma once
+#include "Move.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class Bound : std::uint8_t {
+	None, Upper, Lower, Exact
+};
+
+struct TTData {
+	Move move;
+	int score = 0;
+	int depth = 0;
+	Bound bound = Bound::None;
+};
+
+class TranspositionTable {
+private:
+	// Each slot stores key ^ data next to data. A torn write from another thread
+	// makes the XOR check fail, so the entry is treated as a miss instead of being trusted.
+	struct Slot {
+		std::atomic<std::uint64_t> check{ 0 };
+		std::atomic<std::uint64_t> data{ 0 };
+	};
+
+	static constexpr int SlotsPerBucket = 4;
+	struct alignas(64) Bucket { // One cache line per bucket
+		Slot slots[SlotsPerBucket];
+	};
+
+	std::unique_ptr<Bucket[]> buckets;
+	std::size_t bucketCount = 0;
+	std::uint8_t generation = 0; // Bumped every search so older entries are replaced first
+
+	Bucket& bucketFor(std::uint64_t key) const { return buckets[key & (bucketCount - 1)]; }
+
+public:
+	explicit TranspositionTable(std::size_t megabytes = 16); // Constructor, size is rounded down to a power of two buckets
+	void resize(std::size_t megabytes);
+	void clear(); // Not thread safe, call between searches
+	void newSearch();
+
+	bool probe(std::uint64_t key, TTData& out) const; // Returns false on a miss
+	void store(std::uint64_t key, const TTData& entry);
+	int hashfull() const; // Permille of sampled slots used by the current search
+};
@@ -0,0 +1,33 @@
+// Types.hpp
+// PieceType and Color enums
+// Square and piece encoding helpers
+
+#pragma once
+#include <cstdint>
+
+enum class PieceType {
+	Pawn, Knight, Bishop, Rook, Queen, King
+};
+
+enum Color : int {
+	White, Black
+};
+
+constexpr Color operator~(Color c) { return static_cast<Color>(c ^ 1); } // Opposite color
+
+// Squares are indexed 0-63 from a1, using the same 1-8 file and rank numbering as the rest of the game
+constexpr int square(int file, int rank) { return (rank - 1) * 8 + (file - 1); }
+constexpr int fileOf(int sq) { return sq % 8 + 1; }
+constexpr int rankOf(int sq) { return sq / 8 + 1; }
+
+// Board geometry seen from one side, constant when the color is a template parameter
+constexpr int pawnPush(Color c) { return c == White ? 8 : -8; } // Square offset of a pawn's single step
+constexpr int relativeRank(Color c, int rank) { return c == White ? rank : 9 - rank; } // Rank 1 is the color's back rank
+
+// Mailbox piece codes, color * 6 + type, with NoPiece for an empty square
+using PieceCode = std::uint8_t;
+constexpr PieceCode NoPiece = 12;
+
+constexpr PieceCode makePiece(Color c, PieceType t) { return static_cast<PieceCode>(c * 6 + static_cast<int>(t)); }
+constexpr Color colorOf(PieceCode p) { return p < 6 ? White : Black; }
+constexpr PieceType typeOf(PieceCode p) { return static_cast<PieceType>(p % 6); }
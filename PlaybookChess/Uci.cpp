@@ -0,0 +1,264 @@
+// Uci.cpp
+// Command parsing and replies for the UCI front-end
+// Uci class functions
+
+#include "Uci.hpp"
+#include "Bench.hpp"
+#include "Notation.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+// Splits a command on spaces and tabs without copying it
+static std::vector<std::string_view> tokenize(std::string_view line) {
+	std::vector<std::string_view> tokens;
+	std::size_t i = 0;
+	while (i < line.size()) {
+		while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+		std::size_t start = i;
+		while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') i++;
+		if (i > start) tokens.push_back(line.substr(start, i - start));
+	}
+	return tokens;
+}
+
+static long long toNumber(std::string_view text) {
+	long long value = 0;
+	std::from_chars(text.data(), text.data() + text.size(), value);
+	return value;
+}
+
+Uci::Uci(std::ostream& output) : tt(16), search(tt, 1), out(output) {
+	position.setFromFen(StartFen);
+	history.push_back(position.getKey());
+}
+
+Uci::~Uci() {
+	stopSearch();
+	flushOutput();
+}
+
+void Uci::send(std::string_view line, bool flushNow) {
+	std::lock_guard<std::mutex> lock(outputMutex);
+	pending.append(line);
+	pending += '\n';
+	if (flushNow) {
+		out << pending;
+		out.flush();
+		pending.clear();
+	}
+}
+
+void Uci::flushOutput() {
+	std::lock_guard<std::mutex> lock(outputMutex);
+	if (pending.empty()) return;
+	out << pending;
+	out.flush();
+	pending.clear();
+}
+
+void Uci::loop(std::istream& in) {
+	std::string line;
+	while (std::getline(in, line)) {
+		if (!execute(line)) break;
+		if (in.rdbuf()->in_avail() <= 0) flushOutput(); // Replies to a burst of commands go out together
+	}
+	stopSearch();
+	flushOutput();
+}
+
+bool Uci::execute(std::string_view line) {
+	std::vector<std::string_view> tokens = tokenize(line);
+	if (tokens.empty()) return true;
+	std::string_view command = tokens[0];
+
+	if (command == "uci") {
+		send("id name PlaybookChess", false);
+		send("id author Casey Haavind", false);
+		send("option name Threads type spin default 1 min 1 max 256", false);
+		send("option name Hash type spin default 16 min 1 max 65536", false);
+		send("uciok", true);
+	}
+	else if (command == "isready") {
+		send("readyok", true);
+	}
+	else if (command == "ucinewgame") {
+		waitForSearch();
+		tt.clear();
+	}
+	else if (command == "position") {
+		waitForSearch();
+		handlePosition(tokens);
+	}
+	else if (command == "go") {
+		waitForSearch();
+		handleGo(tokens);
+	}
+	else if (command == "stop") {
+		stopSearch();
+	}
+	else if (command == "setoption") {
+		waitForSearch();
+		handleSetOption(tokens);
+	}
+	else if (command == "bench") {
+		waitForSearch();
+		handleBench(tokens);
+	}
+	else if (command == "d") { // Debugging aid, not part of UCI
+		send(position.toFen(), true);
+	}
+	else if (command == "quit") {
+		return false;
+	}
+	return true;
+}
+
+// position [startpos | fen <6 fields>] [moves <m1> <m2> ...]
+void Uci::handlePosition(const std::vector<std::string_view>& tokens) {
+	std::size_t i = 1;
+	std::string fen;
+	if (i < tokens.size() && tokens[i] == "startpos") {
+		fen = StartFen;
+		i++;
+	}
+	else if (i < tokens.size() && tokens[i] == "fen") {
+		for (i++; i < tokens.size() && tokens[i] != "moves"; i++) {
+			if (!fen.empty()) fen += ' ';
+			fen.append(tokens[i]);
+		}
+	}
+	else return;
+
+	if (!position.setFromFen(fen)) {
+		send("info string invalid fen " + fen, true);
+		position.setFromFen(StartFen);
+	}
+	history.assign(1, position.getKey());
+
+	if (i < tokens.size() && tokens[i] == "moves") {
+		for (i++; i < tokens.size(); i++) {
+			Move move;
+			if (!moveFromString(position, tokens[i], move)) {
+				send("info string illegal move " + std::string(tokens[i]), true);
+				break;
+			}
+			UndoInfo undo;
+			position.makeMove(move, undo);
+			history.push_back(position.getKey());
+		}
+	}
+}
+
+// go [depth n] [movetime ms] [nodes n] [infinite] [wtime ms btime ms winc ms binc ms movestogo n]
+void Uci::handleGo(const std::vector<std::string_view>& tokens) {
+	SearchLimits limits;
+	long long timeLeft[2] = { 0, 0 }, increment[2] = { 0, 0 }, movesToGo = 0;
+	for (std::size_t i = 1; i < tokens.size(); i++) {
+		std::string_view key = tokens[i];
+		bool hasValue = i + 1 < tokens.size();
+		if (key == "infinite") limits.infinite = true;
+		else if (!hasValue) break;
+		else if (key == "depth") limits.depth = std::clamp(static_cast<int>(toNumber(tokens[++i])), 1, MaxPly - 1);
+		else if (key == "movetime") limits.movetimeMs = static_cast<int>(toNumber(tokens[++i]));
+		else if (key == "nodes") limits.nodes = static_cast<std::uint64_t>(toNumber(tokens[++i]));
+		else if (key == "wtime") timeLeft[White] = toNumber(tokens[++i]);
+		else if (key == "btime") timeLeft[Black] = toNumber(tokens[++i]);
+		else if (key == "winc") increment[White] = toNumber(tokens[++i]);
+		else if (key == "binc") increment[Black] = toNumber(tokens[++i]);
+		else if (key == "movestogo") movesToGo = toNumber(tokens[++i]);
+	}
+
+	Color us = position.sideToMove();
+	if (!limits.movetimeMs && timeLeft[us] > 0) limits.movetimeMs = allocateMoveTime(timeLeft[us], increment[us], movesToGo);
+
+	infinite = limits.infinite;
+	stopReceived.store(false);
+	searchThread = std::thread([this, limits] {
+		// think resets its stop flag when it starts, so a stop that arrives before then is applied after the first iteration
+		auto onIteration = [this](const SearchResult& result) {
+			if (stopReceived.load()) search.stop();
+			send(infoLine(result), result.seconds >= 0.05); // Short searches send their info with bestmove
+		};
+		SearchResult result = search.think(position, limits, history, onIteration);
+
+		if (infinite) { // UCI only allows bestmove after stop in infinite mode
+			std::unique_lock<std::mutex> lock(stopMutex);
+			stopWake.wait(lock, [this] { return stopReceived.load(); });
+		}
+
+		std::string best = "bestmove " + (result.hasMove ? moveToString(result.bestMove) : std::string("0000"));
+		if (result.pv.size() > 1) best += " ponder " + moveToString(result.pv[1]);
+		send(best, true);
+	});
+}
+
+void Uci::waitForSearch() {
+	if (infinite) stopSearch();
+	else if (searchThread.joinable()) searchThread.join();
+}
+
+void Uci::stopSearch() {
+	if (!searchThread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(stopMutex);
+		stopReceived.store(true);
+	}
+	stopWake.notify_one();
+	search.stop();
+	searchThread.join();
+}
+
+// setoption name <Threads|Hash> value <n>
+void Uci::handleSetOption(const std::vector<std::string_view>& tokens) {
+	std::string_view name, value;
+	for (std::size_t i = 1; i + 1 < tokens.size(); i++) {
+		if (tokens[i] == "name") name = tokens[i + 1];
+		else if (tokens[i] == "value") value = tokens[i + 1];
+	}
+
+	if (name == "Threads") {
+		threads = std::clamp(static_cast<int>(toNumber(value)), 1, 256);
+		search.setThreads(threads);
+	}
+	else if (name == "Hash") {
+		hashMb = std::clamp(static_cast<int>(toNumber(value)), 1, 65536);
+		tt.resize(static_cast<std::size_t>(hashMb));
+	}
+	else {
+		send("info string unknown option " + std::string(name), true);
+	}
+}
+
+// bench [depth], same suite as the bench tool, with the current Threads and Hash settings
+void Uci::handleBench(const std::vector<std::string_view>& tokens) {
+	int depth = tokens.size() > 1 ? std::clamp(static_cast<int>(toNumber(tokens[1])), 1, MaxPly - 1) : 6;
+	std::ostringstream lines;
+	BenchResult result = runBench(depth, threads, hashMb, &lines);
+
+	send(lines.str(), false);
+	send("Nodes searched: " + std::to_string(result.nodes), false);
+	send("NPS: " + std::to_string(result.nps()), true);
+}
+
+std::string Uci::infoLine(const SearchResult& result) const {
+	std::string line = "info depth " + std::to_string(result.depth) + " score ";
+	if (std::abs(result.score) >= MateScore - MaxPly) { // Mate in moves, negative when the side to move is mated
+		int plies = MateScore - std::abs(result.score);
+		int moves = (plies + 1) / 2;
+		line += "mate " + std::to_string(result.score > 0 ? moves : -moves);
+	}
+	else {
+		line += "cp " + std::to_string(result.score);
+	}
+
+	std::uint64_t nps = result.seconds > 0 ? static_cast<std::uint64_t>(result.nodes / result.seconds) : 0;
+	line += " nodes " + std::to_string(result.nodes) + " nps " + std::to_string(nps)
+		+ " time " + std::to_string(static_cast<long long>(result.seconds * 1000))
+		+ " hashfull " + std::to_string(tt.hashfull()) + " pv";
+	for (const Move& m : result.pv) line += " " + moveToString(m);
+	return line;
+}
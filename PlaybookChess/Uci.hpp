@@ -0,0 +1,58 @@
+// Uci.hpp
+// Uci class
+// Universal Chess Interface front-end, drives the search from text commands instead of the window
+
+#pragma once
+#include "Position.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class Uci {
+private:
+	TranspositionTable tt;
+	Search search; // Uses tt
+	int threads = 1;
+	int hashMb = 16;
+
+	Position position; // Set by the last position command
+	std::vector<std::uint64_t> history; // Keys of every position from the position command's start, for repetition detection
+
+	std::thread searchThread; // Runs think and prints bestmove, joined before the next search or option change
+	std::atomic<bool> stopReceived{ false };
+	bool infinite = false; // bestmove waits for stop, even if the search ends first
+	std::mutex stopMutex;
+	std::condition_variable stopWake;
+
+	// Replies are collected in pending and written in batches, so fast command loops do not flush every line
+	std::ostream& out;
+	std::string pending;
+	std::mutex outputMutex; // Both the input and search threads write
+
+	void send(std::string_view line, bool flushNow);
+	void flushOutput();
+
+	void handlePosition(const std::vector<std::string_view>& tokens);
+	void handleGo(const std::vector<std::string_view>& tokens);
+	void handleSetOption(const std::vector<std::string_view>& tokens);
+	void handleBench(const std::vector<std::string_view>& tokens);
+	void stopSearch(); // Stops any running search and waits for its bestmove
+	void waitForSearch(); // Lets a running search finish on its own limits, an infinite one is stopped instead
+
+	std::string infoLine(const SearchResult& result) const;
+
+public:
+	explicit Uci(std::ostream& output); // Constructor, replies are written to output
+	~Uci();
+
+	bool execute(std::string_view line); // Handles one command, returns false on quit
+	void loop(std::istream& in); // Reads commands until quit or end of input
+};
@@ -0,0 +1,24 @@
+// UciMain.cpp
+// Headless UCI engine, no window or SFML needed
+// Usage: uci            reads UCI commands from stdin
+//        uci bench [n]  runs the bench command and exits
+
+#include "Uci.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+	std::ios::sync_with_stdio(false); // Buffered input and output, flushes are done by Uci
+	std::cin.tie(nullptr);
+
+	Uci uci(std::cout);
+	if (argc > 1) { // Arguments are run as one command
+		std::string command;
+		for (int i = 1; i < argc; i++) command += std::string(i > 1 ? " " : "") + argv[i];
+		uci.execute(command);
+		return 0;
+	}
+
+	uci.loop(std::cin);
+	return 0;
+}
@@ -0,0 +1,309 @@
+// Validate.cpp
+// In-place PGN and EPD parsing and replay
+// Each chunk is parsed on its own thread into its own results, which are joined in input order
+
+#include "Validate.hpp"
+#include "MoveGen.hpp"
+#include "Notation.hpp"
+#include "Position.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// Results for one chunk, game numbers are local to the chunk until the chunks are joined
+struct ChunkResult {
+	std::uint64_t games = 0;
+	std::uint64_t moves = 0;
+	std::vector<ValidationIssue> issues;
+	std::vector<std::string> finalFens;
+};
+
+bool isSpace(char ch) { return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n'; }
+
+// Setup positions need one king each and the side that just moved must not be in check
+bool isPlayablePosition(const Position& position) {
+	for (Color c : { White, Black })
+		if (popCount(position.pieces(c, PieceType::King)) != 1) return false;
+	return !position.isInCheck(~position.sideToMove());
+}
+
+// PGN parser for one chunk. The cursor only moves forward and every token is a view into the chunk.
+class PgnChunkParser {
+private:
+	std::string_view text;
+	std::size_t base; // Offset of the chunk in the whole input
+	bool keepFens;
+	const MoveVisitor& visitor;
+	ChunkResult& out;
+	std::size_t pos = 0;
+
+	// Current game
+	bool inGame = false;
+	bool inMovetext = false;
+	bool failed = false; // After an illegal move, the rest of the game is skipped
+	bool positioned = false;
+	std::string_view fenTag;
+	std::size_t gameOffset = 0;
+	int ply = 0;
+	Position position;
+
+	void issue(std::size_t at, std::string message) {
+		out.issues.push_back({ static_cast<std::size_t>(out.games + 1), base + at, ply, std::move(message) });
+		failed = true;
+	}
+
+	void startGame(std::size_t at) {
+		inGame = true;
+		inMovetext = false;
+		failed = false;
+		positioned = false;
+		fenTag = {};
+		gameOffset = at;
+		ply = 0;
+	}
+
+	void finishGame() {
+		if (!inGame) return;
+		if (!positioned && !failed) setUp(gameOffset); // A game with tags but no moves still has a position
+		if (keepFens) out.finalFens.push_back(failed ? std::string() : position.toFen());
+		out.games++;
+		inGame = false;
+		inMovetext = false;
+	}
+
+	void setUp(std::size_t at) {
+		positioned = true;
+		if (fenTag.empty()) {
+			position.setFromFen(StartFen);
+			return;
+		}
+		if (!position.setFromFen(std::string(fenTag)) || !isPlayablePosition(position))
+			issue(at, "invalid FEN tag \"" + std::string(fenTag) + "\"");
+	}
+
+	void skipPast(char close) {
+		std::size_t end = text.find(close, pos);
+		pos = end == std::string_view::npos ? text.size() : end + 1;
+	}
+
+	void skipVariation() { // Variations nest and can hold comments containing parentheses
+		int depth = 0;
+		while (pos < text.size()) {
+			char ch = text[pos++];
+			if (ch == '{') skipPast('}');
+			else if (ch == '(') depth++;
+			else if (ch == ')' && --depth == 0) return;
+		}
+	}
+
+	void readTag() {
+		std::size_t start = pos;
+		skipPast(']');
+		std::string_view tag = text.substr(start + 1, pos - start - 2);
+		if (inMovetext) { // A tag after movetext starts the next game
+			finishGame();
+		}
+		if (!inGame) startGame(start);
+
+		std::size_t nameEnd = tag.find_first_of(" \t");
+		if (nameEnd == std::string_view::npos) return;
+		std::string_view name = tag.substr(0, nameEnd);
+		std::size_t open = tag.find('"'), close = tag.rfind('"');
+		if (name == "FEN" && open != std::string_view::npos && close > open)
+			fenTag = tag.substr(open + 1, close - open - 1);
+	}
+
+	void readToken() {
+		std::size_t start = pos;
+		while (pos < text.size() && !isSpace(text[pos]) && text[pos] != '{' && text[pos] != '(' && text[pos] != ')'
+			&& text[pos] != '[' && text[pos] != ';')
+			pos++;
+		std::string_view token = text.substr(start, pos - start);
+		if (token.empty()) { pos++; return; } // Stray ')' or similar
+
+		if (!inGame) startGame(start);
+		inMovetext = true;
+
+		if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+			finishGame();
+			return;
+		}
+		if (token[0] == '$') return; // Numeric annotation glyph
+
+		// Move numbers, possibly joined to the move as in 12.e4 or 12...Nf6
+		std::size_t digits = 0;
+		while (digits < token.size() && token[digits] >= '0' && token[digits] <= '9') digits++;
+		if (digits > 0 && digits < token.size() && token[digits] == '.') {
+			token.remove_prefix(digits);
+			while (!token.empty() && token.front() == '.') token.remove_prefix(1);
+			if (token.empty()) return;
+		}
+		else if (digits == token.size()) return;
+
+		if (failed) return;
+		if (!positioned) {
+			setUp(start);
+			if (failed) return;
+		}
+
+		Move move;
+		if (!moveFromSan(position, token, move)) {
+			issue(start, "illegal move " + std::string(token) + " in " + position.toFen());
+			return;
+		}
+		if (visitor) visitor(position, move, ply);
+		UndoInfo undo;
+		position.makeMove(move, undo);
+		ply++;
+		out.moves++;
+	}
+
+public:
+	PgnChunkParser(std::string_view chunk, std::size_t offset, bool keepFinalFens, const MoveVisitor& moveVisitor, ChunkResult& result)
+		: text(chunk), base(offset), keepFens(keepFinalFens), visitor(moveVisitor), out(result) {}
+
+	void run() {
+		while (pos < text.size()) {
+			char ch = text[pos];
+			if (isSpace(ch)) pos++;
+			else if (ch == '[') readTag();
+			else if (ch == '{') skipPast('}');
+			else if (ch == ';') skipPast('\n');
+			else if (ch == '%' && (pos == 0 || text[pos - 1] == '\n')) skipPast('\n'); // Escape line
+			else if (ch == '(') skipVariation();
+			else readToken();
+		}
+		finishGame();
+	}
+};
+
+// EPD record: four FEN fields, then operations such as bm Nf3; id "name";
+void validateEpdChunk(std::string_view text, std::size_t base, bool keepFens, ChunkResult& out) {
+	Position position;
+	std::size_t pos = 0;
+	while (pos < text.size()) {
+		std::size_t end = text.find('\n', pos);
+		if (end == std::string_view::npos) end = text.size();
+		std::string_view line = text.substr(pos, end - pos);
+		std::size_t lineOffset = base + pos;
+		pos = end + 1;
+
+		while (!line.empty() && isSpace(line.back())) line.remove_suffix(1);
+		while (!line.empty() && isSpace(line.front())) { line.remove_prefix(1); lineOffset++; }
+		if (line.empty() || line[0] == '#') continue;
+		std::size_t record = static_cast<std::size_t>(++out.games);
+
+		// The end of the fourth field splits position from operations
+		std::size_t fieldEnd = 0;
+		for (int field = 0; field < 4 && fieldEnd != std::string_view::npos; field++) {
+			fieldEnd = line.find_first_not_of(" \t", fieldEnd);
+			if (fieldEnd != std::string_view::npos) fieldEnd = line.find_first_of(" \t", fieldEnd);
+		}
+		std::string_view fen = line.substr(0, fieldEnd);
+		std::string_view operations = fieldEnd == std::string_view::npos ? std::string_view() : line.substr(fieldEnd);
+
+		if (!position.setFromFen(std::string(fen)) || !isPlayablePosition(position)) {
+			out.issues.push_back({ record, lineOffset, 0, "invalid position " + std::string(fen) });
+			if (keepFens) out.finalFens.emplace_back();
+			continue;
+		}
+
+		// bm and am operands must be legal moves in the position
+		while (!operations.empty()) {
+			std::size_t semicolon = operations.find(';');
+			std::string_view operation = operations.substr(0, semicolon);
+			operations = semicolon == std::string_view::npos ? std::string_view() : operations.substr(semicolon + 1);
+
+			std::size_t start = operation.find_first_not_of(" \t");
+			if (start == std::string_view::npos) continue;
+			operation.remove_prefix(start);
+			std::size_t opEnd = operation.find_first_of(" \t");
+			std::string_view opcode = operation.substr(0, opEnd);
+			if ((opcode != "bm" && opcode != "am") || opEnd == std::string_view::npos) continue;
+
+			std::string_view operands = operation.substr(opEnd);
+			while (!operands.empty()) {
+				std::size_t a = operands.find_first_not_of(" \t");
+				if (a == std::string_view::npos) break;
+				std::size_t b = operands.find_first_of(" \t", a);
+				std::string_view san = operands.substr(a, b == std::string_view::npos ? std::string_view::npos : b - a);
+				operands = b == std::string_view::npos ? std::string_view() : operands.substr(b);
+
+				Move move;
+				out.moves++;
+				if (!moveFromSan(position, san, move))
+					out.issues.push_back({ record, base + static_cast<std::size_t>(san.data() - text.data()), 0,
+						std::string(opcode) + " move " + std::string(san) + " is not legal" });
+			}
+		}
+		if (keepFens) out.finalFens.push_back(position.toFen());
+	}
+}
+
+} // namespace
+
+std::vector<std::string_view> splitChunks(std::string_view text, InputFormat format, int count) {
+	std::vector<std::string_view> chunks;
+	count = std::max(1, count);
+	std::size_t start = 0;
+	for (int i = 1; i <= count && start < text.size(); i++) {
+		std::size_t end = i == count ? text.size() : std::max(start, text.size() / count * i);
+
+		// Move the cut forward to the next record start
+		while (end < text.size()) {
+			std::size_t newline = text.find('\n', end);
+			if (newline == std::string_view::npos) { end = text.size(); break; }
+			end = newline + 1;
+			if (format == InputFormat::Epd) break;
+
+			// PGN games start with a tag line after an empty line
+			bool tagNext = end < text.size() && text[end] == '[';
+			std::size_t prev = newline;
+			if (prev > 0 && text[prev - 1] == '\r') prev--;
+			bool blankBefore = prev == 0 || text[prev - 1] == '\n';
+			if (tagNext && blankBefore) break;
+		}
+		chunks.push_back(text.substr(start, end - start));
+		start = end;
+	}
+	return chunks;
+}
+
+ValidationReport validateText(std::string_view text, InputFormat format, int threads, bool keepFinalFens, const MoveVisitor& visitor) {
+	auto startTime = std::chrono::steady_clock::now();
+	threads = std::max(1, threads);
+
+	// More chunks than threads keeps every core busy when some chunks hold longer games
+	std::vector<std::string_view> chunks = splitChunks(text, format, threads * 8);
+	std::vector<ChunkResult> results(chunks.size());
+	std::atomic<std::size_t> next{ 0 };
+
+	auto work = [&] {
+		for (std::size_t i = next++; i < chunks.size(); i = next++) {
+			std::size_t offset = static_cast<std::size_t>(chunks[i].data() - text.data());
+			if (format == InputFormat::Pgn) PgnChunkParser(chunks[i], offset, keepFinalFens, visitor, results[i]).run();
+			else validateEpdChunk(chunks[i], offset, keepFinalFens, results[i]);
+		}
+	};
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads; t++) pool.emplace_back(work);
+	work();
+	for (auto& t : pool) t.join();
+
+	// Join in input order, turning chunk game numbers into input game numbers
+	ValidationReport report;
+	for (ChunkResult& r : results) {
+		for (ValidationIssue& issue : r.issues) {
+			issue.game += static_cast<std::size_t>(report.games);
+			report.issues.push_back(std::move(issue));
+		}
+		for (std::string& fen : r.finalFens) report.finalFens.push_back(std::move(fen));
+		report.games += r.games;
+		report.moves += r.moves;
+	}
+	report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return report;
+}
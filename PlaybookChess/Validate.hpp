@@ -0,0 +1,41 @@
+// Validate.hpp
+// Batch validation of PGN games and EPD positions against the rules, split across threads
+
+#pragma once
+#include "Move.hpp"
+#include "Position.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class InputFormat {
+	Pgn, Epd
+};
+
+struct ValidationIssue {
+	std::size_t game = 0; // Game or EPD record, counted from 1
+	std::size_t offset = 0; // Byte offset of the offending text in the input
+	int ply = 0; // Half moves played before the problem, 0 for setup problems
+	std::string message; // Only built when something is wrong
+};
+
+struct ValidationReport {
+	std::uint64_t games = 0; // Games or EPD records read
+	std::uint64_t moves = 0; // Moves replayed, or EPD best and avoid moves checked
+	std::vector<ValidationIssue> issues; // In input order
+	std::vector<std::string> finalFens; // One per game, in input order, only when asked for
+	double seconds = 0;
+};
+
+// Splits text into up to count pieces that each start at a game or record boundary
+std::vector<std::string_view> splitChunks(std::string_view text, InputFormat format, int count);
+
+// Called for every replayed PGN move with the position before it, on the thread that parsed the game
+using MoveVisitor = std::function<void(const Position& before, const Move& move, int ply)>;
+
+// Replays every game, or checks every record, on threads threads. The text is tokenized in place.
+ValidationReport validateText(std::string_view text, InputFormat format, int threads, bool keepFinalFens = false,
+	const MoveVisitor& visitor = nullptr);
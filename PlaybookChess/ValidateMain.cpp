@@ -0,0 +1,72 @@
+// ValidateMain.cpp
+// Headless batch validator for PGN and EPD files, no window or SFML needed
+// Usage: validate <file> [--threads n] [--epd | --pgn] [--fens] [--max-issues n]
+// The format follows the extension unless given. Exits with an error if any game or record has a problem.
+
+#include "MappedFile.hpp"
+#include "Validate.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: validate <file> [--threads n] [--epd | --pgn] [--fens] [--max-issues n]" << std::endl;
+		return 2;
+	}
+
+	std::string path = argv[1];
+	int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	bool keepFens = false;
+	std::size_t maxIssues = 50;
+	InputFormat format = path.size() >= 4 && path.compare(path.size() - 4, 4, ".epd") == 0 ? InputFormat::Epd : InputFormat::Pgn;
+
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--epd") format = InputFormat::Epd;
+		else if (arg == "--pgn") format = InputFormat::Pgn;
+		else if (arg == "--fens") keepFens = true;
+		else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--max-issues" && i + 1 < argc) maxIssues = static_cast<std::size_t>(std::atoll(argv[++i]));
+	}
+
+	MappedFile file;
+	if (!file.open(path)) {
+		std::cerr << "ERROR: Could not open " << path << std::endl;
+		return 2;
+	}
+
+	ValidationReport report = validateText(file.view(), format, threads, keepFens);
+
+	// Line numbers are only worked out for the issues that are printed, in one pass over the file
+	std::string_view text = file.view();
+	std::size_t line = 1, scanned = 0;
+	for (std::size_t i = 0; i < report.issues.size() && i < maxIssues; i++) {
+		const ValidationIssue& issue = report.issues[i];
+		line += static_cast<std::size_t>(std::count(text.begin() + scanned, text.begin() + issue.offset, '\n'));
+		scanned = issue.offset;
+		std::cout << path << ":" << line << ": " << (format == InputFormat::Pgn ? "game " : "record ") << issue.game;
+		if (issue.ply > 0) std::cout << ", ply " << issue.ply + 1;
+		std::cout << ": " << issue.message << "\n";
+	}
+	if (report.issues.size() > maxIssues)
+		std::cout << "... " << report.issues.size() - maxIssues << " more issues\n";
+
+	if (keepFens) {
+		for (std::size_t i = 0; i < report.finalFens.size(); i++)
+			std::cout << (format == InputFormat::Pgn ? "game " : "record ") << i + 1 << ": "
+				<< (report.finalFens[i].empty() ? "(invalid)" : report.finalFens[i]) << "\n";
+	}
+
+	double seconds = std::max(report.seconds, 1e-9);
+	std::cout << (format == InputFormat::Pgn ? "Games: " : "Records: ") << report.games << "\n";
+	std::cout << "Moves: " << report.moves << "\n";
+	std::cout << "Issues: " << report.issues.size() << "\n";
+	std::cout << "Time: " << report.seconds << " s on " << threads << " threads\n";
+	std::cout << "Throughput: " << static_cast<std::uint64_t>(report.games / seconds) << " games/s, "
+		<< static_cast<std::uint64_t>(report.moves / seconds) << " moves/s, "
+		<< file.size() / seconds / (1024 * 1024) << " MB/s" << std::endl;
+	return report.issues.empty() ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+// Zobrist.cpp
+// Fills the Zobrist keys from a fixed seed so keys are identical on every run and platform
+
+#include "Zobrist.hpp"
+
+std::uint64_t ZobristPiece[12][64];
+std::uint64_t ZobristCastling[16];
+std::uint64_t ZobristEnPassant[8];
+std::uint64_t ZobristSide;
+
+// xorshift64* generator, small and good enough for hash keys
+static std::uint64_t nextRandom(std::uint64_t& state) {
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717ULL;
+}
+
+static const bool keysReady = [] {
+	std::uint64_t state = 1070372ULL;
+
+	for (auto& piece : ZobristPiece)
+		for (auto& key : piece)
+			key = nextRandom(state);
+
+	// Each right gets a key, a combination is the XOR of its rights
+	std::uint64_t rightKeys[4];
+	for (auto& key : rightKeys) key = nextRandom(state);
+	for (int rights = 0; rights < 16; rights++) {
+		ZobristCastling[rights] = 0;
+		for (int bit = 0; bit < 4; bit++)
+			if (rights & (1 << bit)) ZobristCastling[rights] ^= rightKeys[bit];
+	}
+
+	for (auto& key : ZobristEnPassant) key = nextRandom(state);
+	ZobristSide = nextRandom(state);
+	return true;
+}();
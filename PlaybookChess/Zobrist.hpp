@@ -0,0 +1,11 @@
+// Zobrist.hpp
+// Random keys for incremental 64-bit position hashing
+
+#pragma once
+#include "Types.hpp"
+#include <cstdint>
+
+extern std::uint64_t ZobristPiece[12][64]; // One key per piece code and square
+extern std::uint64_t ZobristCastling[16]; // One key per combination of castling rights, zero for none
+extern std::uint64_t ZobristEnPassant[8]; // One key per en passant file
+extern std::uint64_t ZobristSide; // Toggled when black is to move
@@ -7,14 +7,82 @@
 //			1.3 Oct 27, 2025: Added piece movement
 //			1.4 Nov 11, 2025: Added selected piece highlighting and turns
 //			1.5 Nov 12, 2025: Added move verification
+//			1.6 Oct 17, 2026: Added computer opponent
+//			1.7 Oct 17, 2026: Redraw only when the board changes
+//			1.8 Oct 17, 2026: Embedded sprites and font
+//			1.9 Oct 17, 2026: Added opening book
+//			1.10 Oct 17, 2026: Added endgame tablebases
+//			1.11 Oct 17, 2026: Added takeback and replay with the arrow keys
+//			1.12 Oct 17, 2026: Pieces kept in fixed slots instead of separate allocations
+//			1.13 Oct 17, 2026: Added legal move dots for the selected or hovered piece
+//			1.14 Oct 17, 2026: Added online play through the game server
+//			1.15 Oct 17, 2026: Added a viewer for large PGN archives
+//			1.16 Oct 17, 2026: Move generation compiled separately for each color and piece type
 // Resources: Used info from
 //			https://www.sfml-dev.org/tutorials/3.0/: for SFML setup, shapes, and text rendering
 //			Used ChatGPT to find what file/line was the root cause for an error
 
 #include "Game.hpp"
+#include <cstdlib>
+#include <string>
 
-int main() {
-	Game game;
+// Options: --engine white|black|both  --movetime <ms>  --depth <n>  --threads <n>  --redraw continuous|events  --stats  --startup-bench  --book <file.bin>  --tb <dir>  --connect <host[:port]>  --join <game id>  --view <file.pgn>  --game <n>  --ply <n>
+int main(int argc, char* argv[]) {
+	GameOptions options;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--stats") { // Options without a value
+			options.showStats = true;
+			continue;
+		}
+		if (arg == "--startup-bench") {
+			options.startupBenchmark = true;
+			continue;
+		}
+		if (i + 1 >= argc) break;
+		std::string value = argv[++i];
+		if (arg == "--engine") {
+			options.engineWhite = value == "white" || value == "both";
+			options.engineBlack = value == "black" || value == "both";
+		}
+		else if (arg == "--movetime") {
+			options.engineMoveTimeMs = std::atoi(value.c_str());
+		}
+		else if (arg == "--depth") {
+			options.engineDepth = std::atoi(value.c_str());
+		}
+		else if (arg == "--threads") {
+			options.engineThreads = std::atoi(value.c_str());
+		}
+		else if (arg == "--book") {
+			options.bookPath = value;
+		}
+		else if (arg == "--tb") {
+			options.tablebasePath = value;
+		}
+		else if (arg == "--connect") {
+			std::size_t colon = value.rfind(':');
+			options.serverHost = value.substr(0, colon);
+			if (colon != std::string::npos) options.serverPort = static_cast<unsigned short>(std::atoi(value.c_str() + colon + 1));
+		}
+		else if (arg == "--join") {
+			options.joinGameId = static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+		}
+		else if (arg == "--view") {
+			options.viewPath = value;
+		}
+		else if (arg == "--game") {
+			options.viewGame = static_cast<std::size_t>(std::strtoull(value.c_str(), nullptr, 10));
+		}
+		else if (arg == "--ply") {
+			options.viewPly = std::atoi(value.c_str());
+		}
+		else if (arg == "--redraw") {
+			options.continuousRedraw = value == "continuous";
+		}
+	}
+
+	Game game(options);
 	game.run();
 	return 0;
 }
\ No newline at end of file
@@ -1,2 +1,16 @@
+// sprites.h
+// Piece atlas and font compiled into the executable
+// Defined in a source file generated by the EmbedAssets build step
+
 #pragma once
+#include <cstddef>
+#include <cstdint>
+
+#ifdef PLAYBOOKCHESS_EMBED_ASSETS
+extern const unsigned embeddedAtlasWidth;
+extern const unsigned embeddedAtlasHeight;
+extern const std::uint8_t embeddedAtlasPixels[]; // RGBA, already in the layout of packPieceAtlas
 
+extern const std::uint8_t embeddedFont[]; // Typography Times Regular.ttf
+extern const std::size_t embeddedFontSize;
+#endif